@@ -0,0 +1,92 @@
+/**
+ * Bit-manipulation kernels for potential-mask scans
+ *
+ * Hot solver loops count and locate set bits in 9-bit potential masks; these
+ * helpers map to single hardware instructions where the compiler provides
+ * builtins and fall back to portable loops everywhere else
+ */
+
+#ifndef BITS_H
+#define BITS_H
+
+#include <stdbool.h>
+
+
+/**
+ * Count the set bits of a mask
+ */
+static inline unsigned
+bits_count (unsigned mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_popcount (mask);
+#else
+  unsigned count = 0;
+  while (mask != 0)
+  {
+    count += mask & 1;
+    mask >>= 1;
+  }
+  return count;
+#endif
+}
+
+
+/**
+ * Get the index of the lowest set bit of a mask
+ *
+ * NOTE: Getting the lowest set bit of an empty mask is undefined
+ */
+static inline unsigned
+bits_first (unsigned mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctz (mask);
+#else
+  unsigned index = 0;
+  while ((mask & 1) == 0)
+  {
+    ++index;
+    mask >>= 1;
+  }
+  return index;
+#endif
+}
+
+
+/**
+ * Get the index of the lowest set bit of a 64-bit mask
+ *
+ * NOTE: Getting the lowest set bit of an empty mask is undefined
+ */
+static inline unsigned
+bits_first64 (unsigned long long mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctzll (mask);
+#else
+  unsigned index = 0;
+  while ((mask & 1) == 0)
+  {
+    ++index;
+    mask >>= 1;
+  }
+  return index;
+#endif
+}
+
+
+/**
+ * Iterate over the indices of all set bits of a mask, in ascending order
+ *
+ * The mask expression is evaluated once, so mutating its source inside the
+ * loop body does not affect the iteration
+ */
+#define BITS_FOREACH(index, mask)                                 \
+  for (                                                           \
+    unsigned bits_iter_ = (mask);                                 \
+    bits_iter_ != 0 && (((index) = bits_first (bits_iter_)), true); \
+    bits_iter_ &= bits_iter_ - 1                                  \
+  )
+
+#endif /* BITS_H */
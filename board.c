@@ -7,7 +7,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+#include "bits.h"
 #include "board.h"
+#include "stats.h"
 
 
 /**
@@ -36,18 +41,17 @@
 
 /**
  * Check if a given xy-pair is in bounds of a Sudoku board
+ *
+ * Only the validated entry points call this; under OPTIMIZE those are
+ * compiled out entirely in favour of the unchecked variants
  */
 static inline bool
 is_in_bounds (board_pos x, board_pos y)
 {
-#ifdef OPTIMIZE
-  return true;
-#else
   return  x >= 0 &&
-          x <  9 &&
+          x <  BOARD_DIM &&
           y >= 0 &&
-          y <  9 ;
-#endif
+          y <  BOARD_DIM ;
 }
 
 /**
@@ -56,12 +60,8 @@ is_in_bounds (board_pos x, board_pos y)
 static inline bool
 is_valid_value (element_value value)
 {
-#ifdef OPTIMIZE
-  return true;
-#else
   return  value >= 0 &&
-          value <  9 ;
-#endif
+          value <  BOARD_DIM ;
 }
 
 
@@ -72,60 +72,150 @@ meta_init (struct metadata *meta)
 }
 
 
+/**
+ * Recompute the combined forbidden masks of every element in one region;
+ * defined alongside the metadata refresh helpers below
+ */
+static void
+forbidden_refresh_region (
+  struct board *board,
+  unsigned char kind,
+  unsigned index
+);
+
+
+/**
+ * Region indices of an element position
+ */
+#define POS_QUAD(pos) \
+  ((((pos) / (BOARD_SUB * BOARD_DIM)) * BOARD_SUB) + \
+   (((pos) % BOARD_DIM) / BOARD_SUB))
+#define POS_ROW(pos)  ((pos) / BOARD_DIM)
+#define POS_COL(pos)  ((pos) % BOARD_DIM)
+
+
+/**
+ * Adjust the candidate populations of an element's three regions for the
+ * potential bits it gained and lost
+ */
+static inline void
+candidates_adjust (
+  struct board *board,
+  unsigned pos,
+  board_mask gained,
+  board_mask lost
+)
+{
+  element_value value;
+
+  BITS_FOREACH (value, gained)
+  {
+    ++(board->candidates_quad[POS_QUAD (pos)][value]);
+    ++(board->candidates_row[POS_ROW (pos)][value]);
+    ++(board->candidates_col[POS_COL (pos)][value]);
+  }
+
+  BITS_FOREACH (value, lost)
+  {
+    --(board->candidates_quad[POS_QUAD (pos)][value]);
+    --(board->candidates_row[POS_ROW (pos)][value]);
+    --(board->candidates_col[POS_COL (pos)][value]);
+  }
+}
+
+
+/**
+ * Check that each of an element's three regions can still produce the
+ * given value: some candidate element remains, or the value is placed
+ */
+static inline bool
+candidates_cover (
+  const struct board *board,
+  unsigned pos,
+  element_value value
+)
+{
+  return
+    (board->candidates_quad[POS_QUAD (pos)][value] != 0 ||
+     meta_has_value (&board->meta_quad[POS_QUAD (pos)], value)) &&
+    (board->candidates_row[POS_ROW (pos)][value] != 0 ||
+     meta_has_value (&board->meta_row[POS_ROW (pos)], value)) &&
+    (board->candidates_col[POS_COL (pos)][value] != 0 ||
+     meta_has_value (&board->meta_col[POS_COL (pos)], value));
+}
+
+
+board_link board_links [BOARD_ELEMS][BOARD_LINK_COUNT];
+
+
 void
-board_make_links (struct board *board)
+board_links_init (void)
 {
-  for (board_pos y = 0; y < 9; ++y)
-    for (board_pos x = 0; x < 9; ++x)
+  static bool links_ready = false;
+
+  if (links_ready)
+    return;
+
+  for (board_pos y = 0; y < BOARD_DIM; ++y)
+    for (board_pos x = 0; x < BOARD_DIM; ++x)
     {
       unsigned pos = ELEM_POS (x, y);
 
       unsigned link_count = -1;
 
-      /* Link column adjacents */
-      for (board_pos lx = 0; lx < 9; ++lx)
+      /* Link row adjacents */
+      for (board_pos lx = 0; lx < BOARD_DIM; ++lx)
         if (lx != x)
-          board->links[pos][++link_count] = BOARD_ELEM (board, lx, y);
+          board_links[pos][++link_count] = ELEM_POS (lx, y);
 
       /* Link column adjacents */
-      for (board_pos ly = 0; ly < 9; ++ly)
+      for (board_pos ly = 0; ly < BOARD_DIM; ++ly)
         if (ly != y)
-          board->links[pos][++link_count] = BOARD_ELEM (board, x, ly);
+          board_links[pos][++link_count] = ELEM_POS (x, ly);
 
       /* Link quadrant adjacents */
       board_pos qx = TO_QUAD (x);
       board_pos qy = TO_QUAD (y);
-      for (board_pos lqy = 0; lqy < 3; ++lqy)
-        for (board_pos lqx = 0; lqx < 3; ++lqx)
+      for (board_pos lqy = 0; lqy < BOARD_SUB; ++lqy)
+        for (board_pos lqx = 0; lqx < BOARD_SUB; ++lqx)
           if ((lqx + qx) != x && (lqy + qy) != y)
-            board->links[pos][++link_count] = BOARD_ELEM (board, lqx + qx, lqy + qy);
+            board_links[pos][++link_count] = ELEM_POS (lqx + qx, lqy + qy);
     }
+
+  links_ready = true;
 }
 
 
 void
 board_init (struct board *board)
 {
-  struct board_element defval;
-  defval.has_value = false;
-  defval.potential = 0x1FF;
-  defval.complexity = 9;
+  /* Set default state: no values, everything potential */
+  for (unsigned pos = 0; pos < BOARD_ELEMS; ++pos)
+  {
+    board->potential[pos] = BOARD_MASK;
+    board->value[pos] = 0;
+  }
 
-  for (board_pos y = 0; y < 9; ++y)
-    for (board_pos x = 0; x < 9; ++x)
-    {
-      struct board_element *elem = BOARD_ELEM (board, x, y);
+  memset (board->has_value, 0, sizeof (board->has_value));
 
-      /* Set default state */
-      memcpy (elem, &defval, sizeof (struct board_element));
-    }
+  memset (board->forbidden, 0, sizeof (board->forbidden));
 
+  /* Every value starts with every element of each region as a candidate */
+  memset (
+      board->candidates_quad, BOARD_DIM, sizeof (board->candidates_quad)
+  );
+  memset (board->candidates_row, BOARD_DIM, sizeof (board->candidates_row));
+  memset (board->candidates_col, BOARD_DIM, sizeof (board->candidates_col));
 
-  board_make_links (board);
+  board_links_init ();
 
-  board->complexity = 9;
-  
-  for (unsigned i = 0; i < 9; ++i)
+  board->complexity = BOARD_DIM;
+
+  /* Every element starts valueless at maximum complexity */
+  memset (board->complexity_counts, 0, sizeof (board->complexity_counts));
+  board->complexity_counts[BOARD_DIM] = BOARD_ELEMS;
+
+  for (unsigned i = 0; i < BOARD_DIM; ++i)
   {
     meta_init (&board->meta_quad[i]);
     meta_init (&board->meta_row[i]);
@@ -134,6 +224,191 @@ board_init (struct board *board)
 }
 
 
+/**
+ * How many journal entries to allocate up front
+ * A couple of placements' worth; the journal grows geometrically on demand
+ */
+#define JOURNAL_DEFAULT_CAPACITY 256
+
+
+void
+journal_init (struct board_journal *journal)
+{
+  journal->entries = malloc (
+      sizeof (struct journal_entry) * JOURNAL_DEFAULT_CAPACITY
+  );
+  journal->length = 0;
+  journal->capacity = JOURNAL_DEFAULT_CAPACITY;
+}
+
+
+void
+journal_clear (struct board_journal *journal)
+{
+  journal->length = 0;
+}
+
+
+void
+journal_free (struct board_journal *journal)
+{
+  free (journal->entries);
+  journal->entries = NULL;
+  journal->length = 0;
+  journal->capacity = 0;
+}
+
+
+/**
+ * Append a blank entry to a journal and return it for population
+ */
+static inline struct journal_entry *
+journal_append (struct board_journal *journal)
+{
+  if (journal->length == journal->capacity)
+  {
+    journal->capacity *= 2;
+
+    /* Disregard NULL return value. What's it gonna do, segfault? :P */
+    journal->entries = realloc (
+        journal->entries,
+        sizeof (struct journal_entry) * journal->capacity
+    );
+  }
+
+  return &journal->entries[journal->length++];
+}
+
+
+/**
+ * Record the prior state of a board element
+ */
+static inline void
+journal_record_elem (
+  struct board_journal *journal,
+  const struct board *board,
+  unsigned pos
+)
+{
+  struct journal_entry *entry = journal_append (journal);
+
+  entry->kind = JOURNAL_ELEM;
+  entry->index = pos;
+  entry->prev.elem.potential = board->potential[pos];
+  entry->prev.elem.value = board->value[pos];
+  entry->prev.elem.has_value = board_elem_has_value (board, pos);
+}
+
+
+/**
+ * Record the prior state of a metadata structure
+ */
+static inline void
+journal_record_meta (
+  struct board_journal *journal,
+  enum journal_kind kind,
+  unsigned index,
+  const struct metadata *meta
+)
+{
+  struct journal_entry *entry = journal_append (journal);
+
+  entry->kind = kind;
+  entry->index = index;
+  entry->prev.meta = *meta;
+}
+
+
+unsigned
+journal_checkpoint (struct board_journal *journal, const struct board *board)
+{
+  unsigned mark = journal->length;
+  struct journal_entry *entry = journal_append (journal);
+
+  entry->kind = JOURNAL_CHECKPOINT;
+  entry->index = 0;
+  entry->prev.state.complexity = board->complexity;
+  memcpy (
+      entry->prev.state.complexity_counts,
+      board->complexity_counts,
+      sizeof (board->complexity_counts)
+  );
+
+  return mark;
+}
+
+
+void
+journal_rewind (
+  struct board_journal *journal,
+  struct board *board,
+  unsigned mark
+)
+{
+  ASSERT (
+    (mark <= journal->length),
+    "Attempt to rewind journal to future mark"
+  );
+
+  while (journal->length > mark)
+  {
+    struct journal_entry *entry = &journal->entries[--(journal->length)];
+
+    switch (entry->kind)
+    {
+      case JOURNAL_ELEM:
+      {
+        /* Candidacy is what a valueless element holds in its potential */
+        board_mask held =
+          board_elem_has_value (board, entry->index)
+            ? 0 : board->potential[entry->index];
+        board_mask restored =
+          entry->prev.elem.has_value ? 0 : entry->prev.elem.potential;
+
+        board->potential[entry->index] = entry->prev.elem.potential;
+        board->value[entry->index] = entry->prev.elem.value;
+        if (entry->prev.elem.has_value)
+          board->has_value[entry->index >> 6] |= 1ULL << (entry->index & 63);
+        else
+          board->has_value[entry->index >> 6] &= ~(1ULL << (entry->index & 63));
+
+        candidates_adjust (
+            board, entry->index, restored & ~held, held & ~restored
+        );
+        break;
+      }
+
+      case JOURNAL_QUAD:
+        board->meta_quad[entry->index] = entry->prev.meta;
+        forbidden_refresh_region (board, JOURNAL_QUAD, entry->index);
+        break;
+
+      case JOURNAL_ROW:
+        board->meta_row[entry->index] = entry->prev.meta;
+        forbidden_refresh_region (board, JOURNAL_ROW, entry->index);
+        break;
+
+      case JOURNAL_COL:
+        board->meta_col[entry->index] = entry->prev.meta;
+        forbidden_refresh_region (board, JOURNAL_COL, entry->index);
+        break;
+
+      case JOURNAL_CHECKPOINT:
+        board->complexity = entry->prev.state.complexity;
+        memcpy (
+            board->complexity_counts,
+            entry->prev.state.complexity_counts,
+            sizeof (board->complexity_counts)
+        );
+        break;
+
+      default:
+        ERROR ("Corrupt journal entry");
+    }
+  }
+}
+
+
 bool
 meta_has_value (const struct metadata *meta, element_value value)
 {
@@ -173,24 +448,68 @@ meta_mark (struct metadata *meta, element_value value, unsigned index)
 }
 
 
+/**
+ * Recompute the combined forbidden masks of every element in one region,
+ * identified as in the journal by kind and metadata index
+ */
+static void
+forbidden_refresh_region (
+  struct board *board,
+  unsigned char kind,
+  unsigned index
+)
+{
+  for (unsigned i = 0; i < BOARD_DIM; ++i)
+  {
+    unsigned pos;
+
+    switch (kind)
+    {
+      case JOURNAL_ROW:
+        pos = (index * BOARD_DIM) + i;
+        break;
+
+      case JOURNAL_COL:
+        pos = (i * BOARD_DIM) + index;
+        break;
+
+      default:
+        pos = ((index / BOARD_SUB) * (BOARD_SUB * BOARD_DIM)) +
+              ((index % BOARD_SUB) * BOARD_SUB) +
+              ((i / BOARD_SUB) * BOARD_DIM) + (i % BOARD_SUB);
+        break;
+    }
+
+    board_pos x = pos % BOARD_DIM;
+    board_pos y = pos / BOARD_DIM;
+
+    board->forbidden[pos] =
+      BOARD_QUAD (board, x, y)->marked |
+      BOARD_ROW (board, y)->marked |
+      BOARD_COL (board, x)->marked;
+  }
+}
+
+
 void
 board_meta_quad_refresh (struct board *board, board_pos qx, board_pos qy)
 {
-  struct metadata *meta = BOARD_QUAD (board, qx * 3, qy * 3);
-  board_pos quad_base_x = qx * 3;
-  board_pos quad_base_y = qy * 3;
+  struct metadata *meta = BOARD_QUAD (board, qx * BOARD_SUB, qy * BOARD_SUB);
+  board_pos quad_base_x = qx * BOARD_SUB;
+  board_pos quad_base_y = qy * BOARD_SUB;
 
   meta_clear_values (meta);
 
-  for (board_pos off_y = 0; off_y < 3; ++off_y)
-    for (board_pos off_x = 0; off_x < 3; ++off_x)
+  for (board_pos off_y = 0; off_y < BOARD_SUB; ++off_y)
+    for (board_pos off_x = 0; off_x < BOARD_SUB; ++off_x)
     {
-      struct board_element *elem =
-        BOARD_ELEM (board, quad_base_x + off_x, quad_base_y + off_y);
+      unsigned pos = ELEM_POS (quad_base_x + off_x, quad_base_y + off_y);
 
-      if (elem->has_value)
-        meta_mark (meta, elem->value, (off_y * 3) + off_x);
+      if (board_elem_has_value (board, pos))
+        meta_mark (meta, board->value[pos], (off_y * BOARD_SUB) + off_x);
     }
+
+  forbidden_refresh_region (board, JOURNAL_QUAD, (qy * BOARD_SUB) + qx);
 }
 
 
@@ -201,13 +520,15 @@ board_meta_row_refresh (struct board *board, board_pos y)
   
   meta_clear_values (meta);
 
-  for (board_pos x = 0; x < 9; ++x)
+  for (board_pos x = 0; x < BOARD_DIM; ++x)
   {
-    struct board_element *elem = BOARD_ELEM (board, x, y);
+    unsigned pos = ELEM_POS (x, y);
 
-    if (elem->has_value)
-      meta_mark (meta, elem->value, x);
+    if (board_elem_has_value (board, pos))
+      meta_mark (meta, board->value[pos], x);
   }
+
+  forbidden_refresh_region (board, JOURNAL_ROW, y);
 }
 
 
@@ -218,16 +539,32 @@ board_meta_col_refresh (struct board *board, board_pos x)
   
   meta_clear_values (meta);
 
-  for (board_pos y = 0; y < 9; ++y)
+  for (board_pos y = 0; y < BOARD_DIM; ++y)
   {
-    struct board_element *elem = BOARD_ELEM (board, x, y);
+    unsigned pos = ELEM_POS (x, y);
 
-    if (elem->has_value)
-      meta_mark (meta, elem->value, y);
+    if (board_elem_has_value (board, pos))
+      meta_mark (meta, board->value[pos], y);
   }
+
+  forbidden_refresh_region (board, JOURNAL_COL, x);
+}
+
+
+bool
+board_meta_can_set_unchecked (
+  const struct board *board,
+  board_pos x,
+  board_pos y,
+  element_value value
+)
+{
+  /* The per-element forbidden mask fuses all three region queries */
+  return ((board->forbidden[ELEM_POS (x, y)] >> value) & 1) == 0;
 }
 
 
+#ifndef OPTIMIZE
 bool
 board_meta_can_set (
   const struct board *board,
@@ -237,17 +574,39 @@ board_meta_can_set (
 )
 {
   if (is_in_bounds (x, y) && is_valid_value (value))
-  {
-    return ! (
-      meta_has_value (BOARD_ROW (board, y), value) ||
-      meta_has_value (BOARD_COL (board, x), value) ||
-      meta_has_value (BOARD_QUAD (board, x, y), value)
-    );
-  }
+    return board_meta_can_set_unchecked (board, x, y, value);
   else ERROR("Invalid parameters to function board_meta_can_set()");
 }
+#endif
+
+
+void
+board_set_unchecked (
+  struct board *board,
+  board_pos x,
+  board_pos y,
+  element_value value
+)
+{
+  ASSERT (
+    board_meta_can_set_unchecked (board, x, y, value),
+    "Attempt to set impossible value on board"
+  );
+
+  unsigned pos = ELEM_POS (x, y);
+
+  /* Element leaves the valueless population */
+  --(board->complexity_counts[board_elem_complexity (board, pos)]);
+
+  board->has_value[pos >> 6] |= 1ULL << (pos & 63);
+  board->value[pos] = value;
+
+  /* The element stops being a candidate for everything it still held */
+  candidates_adjust (board, pos, 0, board->potential[pos]);
+}
 
 
+#ifndef OPTIMIZE
 void
 board_set (
   struct board *board,
@@ -257,21 +616,40 @@ board_set (
 )
 {
   if (is_in_bounds (x, y) && is_valid_value (value))
+    board_set_unchecked (board, x, y, value);
+  else ERROR("Invalid parameters to function board_set()");
+}
+#endif
+
+
+void
+board_mark_unchecked (
+  struct board *board,
+  board_pos x,
+  board_pos y,
+  element_value value
+)
+{
+  ASSERT (
+    ! board_elem_has_value (board, ELEM_POS (x, y)),
+    "Attempt to mark element with value"
+  );
+
+  unsigned pos = ELEM_POS (x, y);
+  if (! elem_is_marked (board, pos, value))
   {
-    ASSERT (
-      board_meta_can_set (board, x, y, value),
-      "Attempt to set impossible value on board"
-    );
+    unsigned complexity = board_elem_complexity (board, pos);
+
+    --(board->complexity_counts[complexity]);
+    board->potential[pos] |= 1 << value;
+    ++(board->complexity_counts[complexity + 1]);
 
-    struct board_element *elem = BOARD_ELEM (board, x, y);
-    
-    elem->has_value = true;
-    elem->value = value;
+    candidates_adjust (board, pos, 1 << value, 0);
   }
-  else ERROR("Invalid parameters to function board_set()");
 }
 
 
+#ifndef OPTIMIZE
 void 
 board_mark (
   struct board *board,
@@ -281,23 +659,30 @@ board_mark (
 )
 {
   if (is_in_bounds (x, y) && is_valid_value (value))
-  {
-    ASSERT (
-      ! board_has_value (board, x, y),
-      "Attempt to mark element with value"
-    );
-
-    struct board_element *elem = BOARD_ELEM (board, x, y);
-    if (! board_is_marked (board, x, y, value))
-    {
-      elem->potential |= 1 << value;
-      ++(elem->complexity);
-    }
-  }
+    board_mark_unchecked (board, x, y, value);
   else ERROR("Invalid parameters to function board_mark()");
 }
+#endif
+
+
+bool
+board_unmark_unchecked (
+  struct board *board,
+  board_pos x,
+  board_pos y,
+  element_value value
+)
+{
+  ASSERT (
+    ! board_elem_has_value (board, ELEM_POS (x, y)),
+    "Attempt to mark element with value"
+  );
+
+  return elem_unmark (board, ELEM_POS (x, y), value);
+}
 
 
+#ifndef OPTIMIZE
 bool 
 board_unmark (
   struct board *board,
@@ -307,35 +692,56 @@ board_unmark (
 )
 {
   if (is_in_bounds (x, y) && is_valid_value (value))
-  {
-    ASSERT (
-      ! board_has_value (board, x, y),
-      "Attempt to mark element with value"
-    );
-
-    return elem_unmark (BOARD_ELEM (board, x, y), value);
-  }
+    return board_unmark_unchecked (board, x, y, value);
   else ERROR("Invalid parameters to function board_unmark()");
 }
+#endif
 
 
 bool
 elem_unmark (
-  struct board_element *elem,
+  struct board *board,
+  board_pos pos,
   element_value value
 )
 {
-  if (elem_is_marked (elem, value))
+  if (elem_is_marked (board, pos, value))
   {
+    unsigned complexity = board_elem_complexity (board, pos);
+
+    --(board->complexity_counts[complexity]);
+
     /* Shift bit to correct place and then invert first 9 bits */
-    elem->potential ^= (1 << value);
-    --(elem->complexity);
+    board->potential[pos] ^= (1 << value);
+
+    ++(board->complexity_counts[complexity - 1]);
+
+    candidates_adjust (board, pos, 0, 1 << value);
+
+    /* Some region just lost its last candidate for an unplaced value */
+    if (! candidates_cover (board, pos, value))
+    {
+      ++solve_stats.region_prunes;
+      return false;
+    }
   }
 
-  return elem->potential != 0;
+  return board->potential[pos] != 0;
+}
+
+
+bool
+board_has_value_unchecked (
+  const struct board *board,
+  board_pos x,
+  board_pos y
+)
+{
+  return board_elem_has_value (board, ELEM_POS (x, y));
 }
 
 
+#ifndef OPTIMIZE
 bool
 board_has_value (
   const struct board *board,
@@ -344,13 +750,24 @@ board_has_value (
 )
 {
   if (is_in_bounds (x, y))
-  {
-    return BOARD_ELEM (board, x, y)->has_value;
-  }
+    return board_has_value_unchecked (board, x, y);
   else ERROR("Invalid parameters to function board_has_value()");
 }
+#endif
+
+
+element_value
+board_get_value_unchecked (
+  const struct board *board,
+  board_pos x,
+  board_pos y
+)
+{
+  return board->value[ELEM_POS (x, y)];
+}
 
 
+#ifndef OPTIMIZE
 element_value
 board_get_value (
   const struct board *board,
@@ -359,87 +776,237 @@ board_get_value (
 )
 {
   if (is_in_bounds (x, y))
-  {
-    return BOARD_ELEM (board, x, y)->value;
-  }
+    return board_get_value_unchecked (board, x, y);
   else ERROR("Invalid parameters to function board_get_value()");
 }
+#endif
 
 
 bool
-board_is_marked (
+board_is_marked_unchecked (
   const struct board *board,
   board_pos x,
   board_pos y,
   element_value value
 )
 {
-  if (is_in_bounds (x, y) && is_valid_value (value))
-  {
-    return elem_is_marked(BOARD_ELEM (board, x, y), value);
-  }
+  return elem_is_marked (board, ELEM_POS (x, y), value);
+}
+
+
+#ifndef OPTIMIZE
+bool
+board_is_marked (
+  const struct board *board,
+  board_pos x,
+  board_pos y,
+  element_value value
+)
+{
+  if (is_in_bounds (x, y) && is_valid_value (value))
+    return board_is_marked_unchecked (board, x, y, value);
   else ERROR("Invalid parameters to function board_is_marked()");
 }
+#endif
 
 
 bool
 elem_is_marked (
-  const struct board_element *elem,
+  const struct board *board,
+  board_pos pos,
   element_value value
 )
 {
-  return elem->potential & (1 << value);
+  return board->potential[pos] & (1 << value);
+}
+
+
+#if defined (__SSE2__) && BOARD_DIM == 9
+
+/**
+ * Expand the low 8 bits of the has_value bitmap into eight 16-bit lanes of
+ * all-ones where the corresponding element has a decided value
+ */
+static inline __m128i
+lanes_with_value_128 (unsigned bits)
+{
+  const __m128i select = _mm_setr_epi16 (1, 2, 4, 8, 16, 32, 64, 128);
+  __m128i spread = _mm_and_si128 (_mm_set1_epi16 ((short) bits), select);
+
+  return _mm_cmpeq_epi16 (spread, select);
+}
+
+
+/**
+ * Per-lane popcount of eight 16-bit lanes, by parallel bit summation
+ */
+static inline __m128i
+popcount_epi16_128 (__m128i v)
+{
+  v = _mm_sub_epi16 (
+      v, _mm_and_si128 (_mm_srli_epi16 (v, 1), _mm_set1_epi16 (0x5555))
+  );
+  v = _mm_add_epi16 (
+      _mm_and_si128 (v, _mm_set1_epi16 (0x3333)),
+      _mm_and_si128 (_mm_srli_epi16 (v, 2), _mm_set1_epi16 (0x3333))
+  );
+  v = _mm_and_si128 (
+      _mm_add_epi16 (v, _mm_srli_epi16 (v, 4)), _mm_set1_epi16 (0x0F0F)
+  );
+
+  return _mm_add_epi16 (
+      _mm_and_si128 (v, _mm_set1_epi16 (0x00FF)), _mm_srli_epi16 (v, 8)
+  );
+}
+
+#endif /* __SSE2__ && BOARD_DIM == 9 */
+
+
+#if defined (__AVX2__) && BOARD_DIM == 9
+
+/**
+ * Expand the low 16 bits of the has_value bitmap into sixteen 16-bit lanes
+ * of all-ones where the corresponding element has a decided value
+ */
+static inline __m256i
+lanes_with_value_256 (unsigned bits)
+{
+  const __m256i select = _mm256_setr_epi16 (
+      1, 2, 4, 8, 16, 32, 64, 128,
+      256, 512, 1024, 2048, 4096, 8192, 16384, (short) 32768
+  );
+  __m256i spread =
+    _mm256_and_si256 (_mm256_set1_epi16 ((short) bits), select);
+
+  return _mm256_cmpeq_epi16 (spread, select);
+}
+
+
+/**
+ * Per-lane popcount of sixteen 16-bit lanes, by parallel bit summation
+ */
+static inline __m256i
+popcount_epi16_256 (__m256i v)
+{
+  v = _mm256_sub_epi16 (
+      v,
+      _mm256_and_si256 (_mm256_srli_epi16 (v, 1), _mm256_set1_epi16 (0x5555))
+  );
+  v = _mm256_add_epi16 (
+      _mm256_and_si256 (v, _mm256_set1_epi16 (0x3333)),
+      _mm256_and_si256 (_mm256_srli_epi16 (v, 2), _mm256_set1_epi16 (0x3333))
+  );
+  v = _mm256_and_si256 (
+      _mm256_add_epi16 (v, _mm256_srli_epi16 (v, 4)),
+      _mm256_set1_epi16 (0x0F0F)
+  );
+
+  return _mm256_add_epi16 (
+      _mm256_and_si256 (v, _mm256_set1_epi16 (0x00FF)),
+      _mm256_srli_epi16 (v, 8)
+  );
 }
 
+#endif /* __AVX2__ && BOARD_DIM == 9 */
+
 
 bool
 board_is_valid (struct board *board)
 {
-  for (board_pos y = 0; y < 9; ++y)
-    for (board_pos x = 0; x < 9; ++x)
-      if (
-            !board_has_value (board, x, y) &&
-            BOARD_ELEM (board, x, y)->potential == 0
-      )
+#if defined (__AVX2__) && BOARD_DIM == 9
+  for (unsigned chunk = 0; chunk < 5; ++chunk)
+  {
+    unsigned bits =
+      (board->has_value[chunk >> 2] >> ((chunk & 3) * 16)) & 0xFFFF;
+
+    __m256i potential =
+      _mm256_loadu_si256 ((const __m256i *) &board->potential[chunk * 16]);
+    __m256i dead = _mm256_cmpeq_epi16 (potential, _mm256_setzero_si256 ());
+
+    /* A zero potential only matters on an element without a value */
+    dead = _mm256_andnot_si256 (lanes_with_value_256 (bits), dead);
+
+    if (_mm256_movemask_epi8 (dead) != 0)
+      return false;
+  }
+
+  return board_elem_has_value (board, 80) || board->potential[80] != 0;
+#elif defined (__SSE2__) && BOARD_DIM == 9
+  for (unsigned chunk = 0; chunk < 10; ++chunk)
+  {
+    unsigned bits =
+      (board->has_value[chunk >> 3] >> ((chunk & 7) * 8)) & 0xFF;
+
+    __m128i potential =
+      _mm_loadu_si128 ((const __m128i *) &board->potential[chunk * 8]);
+    __m128i dead = _mm_cmpeq_epi16 (potential, _mm_setzero_si128 ());
+
+    /* A zero potential only matters on an element without a value */
+    dead = _mm_andnot_si128 (lanes_with_value_128 (bits), dead);
+
+    if (_mm_movemask_epi8 (dead) != 0)
+      return false;
+  }
+
+  return board_elem_has_value (board, 80) || board->potential[80] != 0;
+#else
+  for (unsigned word = 0; word < BOARD_HAS_WORDS; ++word)
+  {
+    unsigned long long empty = board_empty_mask (board, word);
+
+    while (empty != 0)
+    {
+      unsigned pos = (word * 64) + bits_first64 (empty);
+      empty &= empty - 1;
+
+      if (board->potential[pos] == 0)
         return false;
+    }
+  }
   return true;
+#endif
 }
 
 
 void
-board_update_marks (
+board_update_marks_unchecked (
   struct board *board,
   board_pos x,
   board_pos y
 )
 {
-  if (is_in_bounds (x, y))
-  {
-    struct board_element *elem = BOARD_ELEM (board, x, y);
+  unsigned pos = ELEM_POS (x, y);
 
-    /* Mark all values as impossible */
-    elem->potential = 0;
-    elem->complexity = 0;
+  --(board->complexity_counts[board_elem_complexity (board, pos)]);
 
-    /* Check x-axis */
-    elem->potential |= BOARD_QUAD (board, x, y)->marked;
-    elem->potential |= BOARD_ROW (board, y)->marked;
-    elem->potential |= BOARD_COL (board, x)->marked;
+  /* All impossible values are fused in the forbidden mask; invert it */
+  board_mask potential = board->forbidden[pos] ^ BOARD_MASK;
 
-    /* Invert matches */
-    elem->potential ^= 0x1FF;
+  candidates_adjust (
+      board,
+      pos,
+      potential & ~board->potential[pos],
+      board->potential[pos] & ~potential
+  );
+  board->potential[pos] = potential;
 
-    /* Count marked bits */
-    unsigned short potential = elem->potential;
-    while (potential != 0)
-    {
-      if ((potential & 1) == 1)
-        ++(elem->complexity);
-      potential >>= 1;
-    }
-  }
+  ++(board->complexity_counts[bits_count (potential)]);
+}
+
+
+#ifndef OPTIMIZE
+void
+board_update_marks (
+  struct board *board,
+  board_pos x,
+  board_pos y
+)
+{
+  if (is_in_bounds (x, y))
+    board_update_marks_unchecked (board, x, y);
   else ERROR("Invalid parameters to function board_update_marks()");
 }
+#endif
 
 
 bool
@@ -457,21 +1024,25 @@ board_can_quad_set_value (
     board_pos quad_y = TO_QUAD (y);
 
     /* Compute sub-quadrant positions */
-    board_pos simp_x = x % 3;
-    board_pos simp_y = y % 3;
+    board_pos simp_x = x % BOARD_SUB;
+    board_pos simp_y = y % BOARD_SUB;
 
 
     bool next = false;
 
     /* Check along x-axis */
-    for (board_pos base_x = 0; base_x < 9; base_x += 3)
+    for (board_pos base_x = 0; base_x < BOARD_DIM; base_x += BOARD_SUB)
     {
       next = false;
       if (base_x != quad_x)
       {
-        for (board_pos check_y = 0; check_y < 3 && ! next; ++check_y)
+        for (board_pos check_y = 0; check_y < BOARD_SUB && ! next; ++check_y)
           if (check_y != simp_y)
-            for (board_pos check_x = 0; check_x < 3 && ! next; ++check_x)
+            for (
+                board_pos check_x = 0;
+                check_x < BOARD_SUB && ! next;
+                ++check_x
+            )
             {
               board_pos target_x = base_x + check_x;
               board_pos target_y = quad_y + check_y;
@@ -482,7 +1053,7 @@ board_can_quad_set_value (
               if (
                   (
                     has_value &&
-                    BOARD_ELEM (board, target_x, target_y)->value == value
+                    board->value[ELEM_POS (target_x, target_y)] == value
                   ) ||
                   (
                     ! has_value &&
@@ -500,14 +1071,18 @@ board_can_quad_set_value (
     }
 
     /* Check along y-axis */
-    for (board_pos base_y = 0; base_y < 9; base_y += 3)
+    for (board_pos base_y = 0; base_y < BOARD_DIM; base_y += BOARD_SUB)
     {
       next = false;
       if (base_y != quad_y)
       {
-        for (board_pos check_x = 0; check_x < 3 && ! next; ++check_x)
+        for (board_pos check_x = 0; check_x < BOARD_SUB && ! next; ++check_x)
           if (check_x != simp_x)
-            for (board_pos check_y = 0; check_y < 3 && ! next; ++check_y)
+            for (
+                board_pos check_y = 0;
+                check_y < BOARD_SUB && ! next;
+                ++check_y
+            )
             {
               board_pos target_x = quad_x + check_x;
               board_pos target_y = base_y + check_y;
@@ -518,7 +1093,7 @@ board_can_quad_set_value (
               if (
                   (
                     has_value &&
-                    BOARD_ELEM (board, target_x, target_y)->value == value
+                    board->value[ELEM_POS (target_x, target_y)] == value
                   ) ||
                   (
                     ! has_value &&
@@ -541,38 +1116,452 @@ board_can_quad_set_value (
 }
 
 
-static inline bool
-field_is_potential (unsigned short field, element_value value)
+/**
+ * Place all hidden singles of one region, whose elements are given by
+ * `positions` in region-relative order
+ *
+ * The `unique` fields of `meta` are rebuilt as candidate-tracking scratch on
+ * every scan, so they are deliberately not journalled
+ *
+ * Returns the number of elements placed, or -1 on a dead region
+ */
+static int
+region_place_hidden_singles (
+  struct board *board,
+  struct board_journal *journal,
+  const board_pos *positions,
+  struct metadata *meta
+)
 {
-  return ((field >> (value * 2)) & 3) < 2;
+  /* Reset candidate tracking for every unplaced value */
+  for (element_value value = 0; value < BOARD_DIM; ++value)
+    if (! meta_has_value (meta, value))
+      meta->unique[value].count = 0;
+
+  /* Count candidate elements per value, saturating at 2 */
+  for (unsigned i = 0; i < BOARD_DIM; ++i)
+  {
+    board_pos pos = positions[i];
+
+    if (board_elem_has_value (board, pos))
+      continue;
+
+    element_value value;
+    BITS_FOREACH (value, board->potential[pos])
+      if (meta->unique[value].count == 0)
+      {
+        meta->unique[value].count = 1;
+        meta->unique[value].index = i;
+      }
+      else if (meta->unique[value].count == 1)
+        meta->unique[value].count = 2;
+  }
+
+  int placed = 0;
+
+  for (element_value value = 0; value < BOARD_DIM; ++value)
+    if (! meta_has_value (meta, value))
+    {
+      /* An unplaced value with no candidate element kills the board */
+      if (meta->unique[value].count == 0)
+        return -1;
+
+      if (meta->unique[value].count == 1)
+      {
+        board_pos pos = positions[meta->unique[value].index];
+        board_pos x = pos % BOARD_DIM;
+        board_pos y = pos / BOARD_DIM;
+
+        /* An earlier placement in this region may have stolen the
+           candidate; only this element could host the value, so that too
+           is a dead board */
+        if (
+            ! elem_is_marked (board, pos, value) ||
+            ! board_meta_can_set (board, x, y, value) ||
+            ! board_place_trial (board, journal, x, y, value)
+        )
+          return -1;
+
+        ++placed;
+        ++solve_stats.hidden_singles;
+      }
+    }
+
+  return placed;
 }
 
 
-static inline void
-field_invalidate (unsigned short *field, element_value value)
+int
+board_place_hidden_singles (
+  struct board *board,
+  struct board_journal *journal
+)
 {
-  *field |= 2 << (value * 2);
+  board_pos positions[BOARD_DIM];
+  int total = 0;
+
+  for (board_pos y = 0; y < BOARD_DIM; ++y)
+  {
+    for (board_pos x = 0; x < BOARD_DIM; ++x)
+      positions[x] = ELEM_POS (x, y);
+
+    int placed =
+      region_place_hidden_singles (
+        board, journal, positions, BOARD_ROW (board, y)
+      );
+    if (placed < 0)
+      return -1;
+    total += placed;
+  }
+
+  for (board_pos x = 0; x < BOARD_DIM; ++x)
+  {
+    for (board_pos y = 0; y < BOARD_DIM; ++y)
+      positions[y] = ELEM_POS (x, y);
+
+    int placed =
+      region_place_hidden_singles (
+        board, journal, positions, BOARD_COL (board, x)
+      );
+    if (placed < 0)
+      return -1;
+    total += placed;
+  }
+
+  for (board_pos qy = 0; qy < BOARD_SUB; ++qy)
+    for (board_pos qx = 0; qx < BOARD_SUB; ++qx)
+    {
+      for (board_pos off_y = 0; off_y < BOARD_SUB; ++off_y)
+        for (board_pos off_x = 0; off_x < BOARD_SUB; ++off_x)
+          positions[(off_y * BOARD_SUB) + off_x] =
+            ELEM_POS ((qx * BOARD_SUB) + off_x, (qy * BOARD_SUB) + off_y);
+
+      int placed =
+        region_place_hidden_singles (
+          board,
+          journal,
+          positions,
+          BOARD_QUAD (board, qx * BOARD_SUB, qy * BOARD_SUB)
+        );
+      if (placed < 0)
+        return -1;
+      total += placed;
+    }
+
+  return total;
 }
 
 
-static inline void
-field_increment (unsigned short *field, element_value value)
+/**
+ * Eliminate naked pair/triple candidates from one region, whose elements
+ * are given by `positions` in region-relative order
+ *
+ * When N unfilled elements all draw their candidates from one mask of N
+ * values (N = 2 or 3), those values must land inside the subset and can be
+ * unmarked from every element outside it
+ *
+ * Returns the number of candidates eliminated, or -1 on a dead region
+ */
+static int
+region_eliminate_subsets (
+  struct board *board,
+  struct board_journal *journal,
+  const board_pos *positions
+)
 {
-  if (field_is_potential (*field, value))
-    *field += (1 << (value * 2));
+  int eliminated = 0;
+
+  for (unsigned i = 0; i < BOARD_DIM; ++i)
+  {
+    board_pos pos = positions[i];
+
+    if (board_elem_has_value (board, pos))
+      continue;
+
+    board_mask mask = board->potential[pos];
+    unsigned size = bits_count (mask);
+
+    if (size != 2 && size != 3)
+      continue;
+
+    /* Count elements whose candidates all fall within the mask */
+    unsigned members = 0;
+    for (unsigned j = 0; j < BOARD_DIM; ++j)
+      if (
+          ! board_elem_has_value (board, positions[j]) &&
+          (board->potential[positions[j]] & ~mask) == 0
+      )
+        ++members;
+
+    /* More confined elements than values kills the board */
+    if (members > size)
+      return -1;
+
+    if (members != size)
+      continue;
+
+    /* Unmark the subset's values from every element outside it */
+    for (unsigned j = 0; j < BOARD_DIM; ++j)
+    {
+      board_pos target = positions[j];
+
+      if (
+          board_elem_has_value (board, target) ||
+          (board->potential[target] & ~mask) == 0 ||
+          (board->potential[target] & mask) == 0
+      )
+        continue;
+
+      journal_record_elem (journal, board, target);
+
+      element_value value;
+      BITS_FOREACH (value, board->potential[target] & mask)
+      {
+        ++eliminated;
+        ++solve_stats.subset_elims;
+
+        if (! elem_unmark (board, target, value))
+          return -1;
+      }
+    }
+  }
+
+  return eliminated;
+}
+
+
+int
+board_eliminate_subsets (
+  struct board *board,
+  struct board_journal *journal
+)
+{
+  board_pos positions[BOARD_DIM];
+  int total = 0;
+
+  for (board_pos y = 0; y < BOARD_DIM; ++y)
+  {
+    for (board_pos x = 0; x < BOARD_DIM; ++x)
+      positions[x] = ELEM_POS (x, y);
+
+    int eliminated =
+      region_eliminate_subsets (board, journal, positions);
+    if (eliminated < 0)
+      return -1;
+    total += eliminated;
+  }
+
+  for (board_pos x = 0; x < BOARD_DIM; ++x)
+  {
+    for (board_pos y = 0; y < BOARD_DIM; ++y)
+      positions[y] = ELEM_POS (x, y);
+
+    int eliminated =
+      region_eliminate_subsets (board, journal, positions);
+    if (eliminated < 0)
+      return -1;
+    total += eliminated;
+  }
+
+  for (board_pos qy = 0; qy < BOARD_SUB; ++qy)
+    for (board_pos qx = 0; qx < BOARD_SUB; ++qx)
+    {
+      for (board_pos off_y = 0; off_y < BOARD_SUB; ++off_y)
+        for (board_pos off_x = 0; off_x < BOARD_SUB; ++off_x)
+          positions[(off_y * BOARD_SUB) + off_x] =
+            ELEM_POS ((qx * BOARD_SUB) + off_x, (qy * BOARD_SUB) + off_y);
+
+      int eliminated =
+        region_eliminate_subsets (board, journal, positions);
+      if (eliminated < 0)
+        return -1;
+      total += eliminated;
+    }
+
+  return total;
+}
+
+
+/**
+ * Rebuild the candidate populations of every region from scratch
+ */
+static void
+candidates_rebuild (struct board *board)
+{
+  memset (board->candidates_quad, 0, sizeof (board->candidates_quad));
+  memset (board->candidates_row, 0, sizeof (board->candidates_row));
+  memset (board->candidates_col, 0, sizeof (board->candidates_col));
+
+  for (unsigned word = 0; word < BOARD_HAS_WORDS; ++word)
+  {
+    unsigned long long empty = board_empty_mask (board, word);
+
+    while (empty != 0)
+    {
+      unsigned pos = (word * 64) + bits_first64 (empty);
+      empty &= empty - 1;
+
+      candidates_adjust (board, pos, board->potential[pos], 0);
+    }
+  }
 }
 
 
 void
 board_update_all_marks (struct board *board)
 {
-  for (board_pos y = 0; y < 9; ++y)
-    for (board_pos x = 0; x < 9; ++x)
+#if (defined (__AVX2__) || defined (__SSE2__)) && BOARD_DIM == 9
+  unsigned short complexity[81];
+
+  /* Recompute every valueless potential from the fused forbidden masks and
+     derive all complexities with a vectorized popcount; elements with a
+     decided value keep their potential untouched */
+#if defined (__AVX2__)
+  for (unsigned chunk = 0; chunk < 5; ++chunk)
+  {
+    unsigned bits =
+      (board->has_value[chunk >> 2] >> ((chunk & 3) * 16)) & 0xFFFF;
+    __m256i valued = lanes_with_value_256 (bits);
+
+    __m256i forbidden =
+      _mm256_loadu_si256 ((const __m256i *) &board->forbidden[chunk * 16]);
+    __m256i candidate = _mm256_andnot_si256 (
+        forbidden, _mm256_set1_epi16 (0x1FF)
+    );
+    __m256i potential =
+      _mm256_loadu_si256 ((const __m256i *) &board->potential[chunk * 16]);
+
+    potential = _mm256_or_si256 (
+        _mm256_and_si256 (valued, potential),
+        _mm256_andnot_si256 (valued, candidate)
+    );
+
+    _mm256_storeu_si256 (
+        (__m256i *) &board->potential[chunk * 16], potential
+    );
+    _mm256_storeu_si256 (
+        (__m256i *) &complexity[chunk * 16], popcount_epi16_256 (potential)
+    );
+  }
+#else
+  for (unsigned chunk = 0; chunk < 10; ++chunk)
+  {
+    unsigned bits =
+      (board->has_value[chunk >> 3] >> ((chunk & 7) * 8)) & 0xFF;
+    __m128i valued = lanes_with_value_128 (bits);
+
+    __m128i forbidden =
+      _mm_loadu_si128 ((const __m128i *) &board->forbidden[chunk * 8]);
+    __m128i candidate = _mm_andnot_si128 (forbidden, _mm_set1_epi16 (0x1FF));
+    __m128i potential =
+      _mm_loadu_si128 ((const __m128i *) &board->potential[chunk * 8]);
+
+    potential = _mm_or_si128 (
+        _mm_and_si128 (valued, potential),
+        _mm_andnot_si128 (valued, candidate)
+    );
+
+    _mm_storeu_si128 ((__m128i *) &board->potential[chunk * 8], potential);
+    _mm_storeu_si128 (
+        (__m128i *) &complexity[chunk * 8], popcount_epi16_128 (potential)
+    );
+  }
+#endif
+
+  /* The vectors cover the first 80 elements; finish the last by hand */
+  if (! board_elem_has_value (board, 80))
+    board->potential[80] = ~board->forbidden[80] & 0x1FF;
+  complexity[80] = bits_count (board->potential[80]);
+
+  /* Rebuild the complexity population from the fresh potentials */
+  memset (board->complexity_counts, 0, sizeof (board->complexity_counts));
+
+  for (unsigned word = 0; word < 2; ++word)
+  {
+    unsigned long long empty = board_empty_mask (board, word);
+
+    while (empty != 0)
+    {
+      unsigned pos = (word * 64) + bits_first64 (empty);
+      empty &= empty - 1;
+
+      ++(board->complexity_counts[complexity[pos]]);
+    }
+  }
+#else
+  for (board_pos y = 0; y < BOARD_DIM; ++y)
+    for (board_pos x = 0; x < BOARD_DIM; ++x)
       if (! board_has_value (board, x, y))
         board_update_marks (board, x, y);
+#endif
+
+  candidates_rebuild (board);
+}
+
+
+bool
+board_place_unchecked (
+  struct board *board,
+  board_pos x,
+  board_pos y,
+  element_value value
+)
+{
+  if (board_meta_can_set_unchecked (board, x, y, value))
+  {
+    unsigned pos = ELEM_POS (x, y);
+
+    /* Unmark all adjacent elements */
+    for (unsigned i = 0; i < BOARD_LINK_COUNT; ++i)
+    {
+      board_pos adjacent = board_links[pos][i];
+
+      if (
+        ! board_elem_has_value (board, adjacent) &&
+        ! elem_unmark (board, adjacent, value)
+      )
+      {
+        /* Unmarking potential caused element to have no potential */
+        ++solve_stats.failed_places;
+        return false;
+      }
+    }
+
+    /* Set value */
+    board_set_unchecked (board, x, y, value);
+
+    /* Update metadata */
+    meta_set_value (BOARD_QUAD (board, x, y), value);
+    meta_set_value (BOARD_ROW  (board, y), value);
+    meta_set_value (BOARD_COL  (board, x), value);
+
+    /* Spread the placed value into the fused forbidden masks */
+    board->forbidden[pos] |= 1 << value;
+    for (unsigned i = 0; i < BOARD_LINK_COUNT; ++i)
+      board->forbidden[board_links[pos][i]] |= 1 << value;
+
+    /* Fail if this element was some region's last candidate for one of
+       the other values it held */
+    element_value other;
+    BITS_FOREACH (other, board->potential[pos] & ~(1 << value))
+      if (! candidates_cover (board, pos, other))
+      {
+        ++solve_stats.region_prunes;
+        ++solve_stats.failed_places;
+        return false;
+      }
+
+    return true;
+  }
+  else
+  {
+    ++solve_stats.failed_places;
+    return false;
+  }
 }
 
 
+#ifndef OPTIMIZE
 bool
 board_place (
   struct board *board,
@@ -582,40 +1571,139 @@ board_place (
 )
 {
   if (is_in_bounds (x, y) && is_valid_value (value))
+    return board_place_unchecked (board, x, y, value);
+  else ERROR("Invalid parameters to function board_place()");
+}
+#endif
+
+
+bool
+board_place_trial_unchecked (
+  struct board *board,
+  struct board_journal *journal,
+  board_pos x,
+  board_pos y,
+  element_value value
+)
+{
+  if (board_meta_can_set_unchecked (board, x, y, value))
   {
-    if (board_meta_can_set (board, x, y, value))
+    unsigned pos = ELEM_POS (x, y);
+
+    /* Unmark all adjacent elements, journalling their prior state */
+    for (unsigned i = 0; i < BOARD_LINK_COUNT; ++i)
     {
-      unsigned pos = ELEM_POS (x, y);
+      board_pos adjacent = board_links[pos][i];
 
-      /* Unmark all adjacent elements */
-      for (unsigned i = 0; i < 20; ++i)
-        if (
-          ! board->links[pos][i]->has_value &&
-          ! elem_unmark (board->links[pos][i], value)
-        )
+      if (! board_elem_has_value (board, adjacent))
+      {
+        journal_record_elem (journal, board, adjacent);
+
+        if (! elem_unmark (board, adjacent, value))
         {
           /* Unmarking potential caused element to have no potential */
+          ++solve_stats.failed_places;
           return false;
         }
+      }
+    }
 
-      /* Set value */
-      board_set (board, x, y, value); 
+    /* Set value */
+    journal_record_elem (journal, board, pos);
+    board_set_unchecked (board, x, y, value);
 
-      /* Update metadata */
-      meta_set_value (BOARD_QUAD (board, x, y), value);
-      meta_set_value (BOARD_ROW  (board, y), value);
-      meta_set_value (BOARD_COL  (board, x), value);
+    /* Update metadata */
+    journal_record_meta (
+      journal,
+      JOURNAL_QUAD,
+      TO_QUAD (y) + (x / BOARD_SUB),
+      BOARD_QUAD (board, x, y)
+    );
+    journal_record_meta (journal, JOURNAL_ROW, y, BOARD_ROW (board, y));
+    journal_record_meta (journal, JOURNAL_COL, x, BOARD_COL (board, x));
+
+    meta_set_value (BOARD_QUAD (board, x, y), value);
+    meta_set_value (BOARD_ROW  (board, y), value);
+    meta_set_value (BOARD_COL  (board, x), value);
+
+    /* Spread the placed value into the fused forbidden masks; the
+       journalled metadata restores them on rewind */
+    board->forbidden[pos] |= 1 << value;
+    for (unsigned i = 0; i < BOARD_LINK_COUNT; ++i)
+      board->forbidden[board_links[pos][i]] |= 1 << value;
+
+    /* Fail if this element was some region's last candidate for one of
+       the other values it held */
+    element_value other;
+    BITS_FOREACH (other, board->potential[pos] & ~(1 << value))
+      if (! candidates_cover (board, pos, other))
+      {
+        ++solve_stats.region_prunes;
+        ++solve_stats.failed_places;
+        return false;
+      }
 
-      return true;
-    }
-    else return false;
+    return true;
+  }
+  else
+  {
+    ++solve_stats.failed_places;
+    return false;
   }
-  else ERROR("Invalid parameters to function board_place()");
 }
 
 
+#ifndef OPTIMIZE
+bool
+board_place_trial (
+  struct board *board,
+  struct board_journal *journal,
+  board_pos x,
+  board_pos y,
+  element_value value
+)
+{
+  if (is_in_bounds (x, y) && is_valid_value (value))
+    return board_place_trial_unchecked (board, journal, x, y, value);
+  else ERROR("Invalid parameters to function board_place_trial()");
+}
+#endif
+
+
+bool
+board_unmark_trial_unchecked (
+  struct board *board,
+  struct board_journal *journal,
+  board_pos x,
+  board_pos y,
+  element_value value
+)
+{
+  journal_record_elem (journal, board, ELEM_POS (x, y));
+
+  return board_unmark_unchecked (board, x, y, value);
+}
+
+
+#ifndef OPTIMIZE
+bool
+board_unmark_trial (
+  struct board *board,
+  struct board_journal *journal,
+  board_pos x,
+  board_pos y,
+  element_value value
+)
+{
+  if (is_in_bounds (x, y) && is_valid_value (value))
+    return board_unmark_trial_unchecked (board, journal, x, y, value);
+  else ERROR("Invalid parameters to function board_unmark_trial()");
+}
+#endif
+
+
 struct board *
-board_place_speculative (
+board_place_speculative_unchecked (
   const struct board *board,
   struct board *board_duplicate,
   board_pos x,
@@ -623,53 +1711,58 @@ board_place_speculative (
   element_value value
 )
 {
-  if (is_in_bounds (x, y) && is_valid_value (value))
+  /* Ensure value can be placed*/
+  if (board_meta_can_set_unchecked (board, x, y, value))
   {
-    /* Ensure value can be placed*/
-    if (board_meta_can_set (board, x, y, value))
-    {
-      /* Create duplicate and place value */
-      board_copy (board, board_duplicate);
+    /* Create duplicate and place value */
+    board_copy (board, board_duplicate);
 
-      if (! board_place (board_duplicate, x, y, value))
-        return NULL;
+    if (! board_place_unchecked (board_duplicate, x, y, value))
+      return NULL;
 
-      board_refresh_complexity (board_duplicate);
+    board_refresh_complexity (board_duplicate);
 
-      return board_duplicate;
-    }
-    else return NULL;
+    return board_duplicate;
   }
+  else return NULL;
+}
+
+
+#ifndef OPTIMIZE
+struct board *
+board_place_speculative (
+  const struct board *board,
+  struct board *board_duplicate,
+  board_pos x,
+  board_pos y,
+  element_value value
+)
+{
+  if (is_in_bounds (x, y) && is_valid_value (value))
+    return board_place_speculative_unchecked (
+        board, board_duplicate, x, y, value
+    );
   else ERROR("Invalid parameters to function board_place_speculative()");
 }
+#endif
 
 
 bool
 board_refresh_complexity (struct board *board)
 {
-  board->complexity = 10;
-  for (board_pos y = 0; y < 9; ++y)
-    for (board_pos x = 0; x < 9; ++x)
-      if (! board_has_value (board, x, y))
-      {
-        struct board_element *elem = BOARD_ELEM (board, x, y);
-        if (elem->complexity < board->complexity)
-        {
-          /* If complexity is somehow 0, we have an invalid board state */
-          if (elem->complexity == 0)
-            return false;
-
-          board->complexity = elem->complexity;
+  /* If any valueless element has no potential, board state is invalid */
+  if (board->complexity_counts[0] != 0)
+    return false;
 
-          /* Short-circuit function on comlpexity=1, since it can't go lower */
-          if (board->complexity == 1)
-            return true;
-        }
-      }
+  for (unsigned complexity = 1; complexity <= BOARD_DIM; ++complexity)
+    if (board->complexity_counts[complexity] != 0)
+    {
+      board->complexity = complexity;
+      return true;
+    }
 
   /* If there are no complex board elements, board is solved */
-  if (board->complexity == 10)
-    board->complexity = 0;
+  board->complexity = 0;
 
   return true;
 }
@@ -678,10 +1771,5 @@ board_refresh_complexity (struct board *board)
 void
 board_copy (const struct board *board_from, struct board *board_to)
 {
-  /* Copy everything except the links */
-  memcpy (
-      board_to,
-      board_from,
-      sizeof(struct board) - sizeof (((struct board *)0)->links)
-  );
+  memcpy (board_to, board_from, sizeof (struct board));
 }
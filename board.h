@@ -6,18 +6,90 @@
 
 #include <stdbool.h>
 
+#include "bits.h"
 
-#define ELEM_POS(x, y) (((y) * 9) + (x))
 
 /**
- * Get a `struct board_element`-entry from a specified location on the board
+ * Board dimension, selectable at compile time: 9 by default, with 16 and 25
+ * supported (see the Makefile targets). Every constant below derives from
+ * it, so loop bounds and masks stay compile-time constants per build and the
+ * 9x9 hot path pays nothing for the parameterization
  */
-#define BOARD_ELEM(board_ptr, x, y) (&(board_ptr)->elements[ELEM_POS (x, y)])
+#ifndef BOARD_DIM
+#define BOARD_DIM 9
+#endif
+
+#if BOARD_DIM == 9
+#define BOARD_SUB 3
+#elif BOARD_DIM == 16
+#define BOARD_SUB 4
+#elif BOARD_DIM == 25
+#define BOARD_SUB 5
+#else
+#error "BOARD_DIM must be 9, 16 or 25"
+#endif
+
+/**
+ * Number of elements on a board
+ */
+#define BOARD_ELEMS (BOARD_DIM * BOARD_DIM)
+
+/**
+ * Number of 64-bit words in the has_value element bitmap
+ */
+#define BOARD_HAS_WORDS ((BOARD_ELEMS + 63) / 64)
+
+/**
+ * Elements adjacent to one element: the rest of its row and column, plus
+ * the quadrant elements sharing neither
+ */
+#define BOARD_LINK_COUNT \
+  ((2 * (BOARD_DIM - 1)) + ((BOARD_SUB - 1) * (BOARD_SUB - 1)))
+
+
+/**
+ * Potential bitmask of one element: one bit per value. The 9x9 board keeps
+ * its 16-bit masks (and with them the vectorized kernels); wider boards
+ * need up to 25 bits
+ */
+#if BOARD_DIM == 9
+typedef unsigned short board_mask;
+#else
+typedef unsigned int board_mask;
+#endif
+
+/**
+ * All values potential, i.e. the mask of a blank element
+ */
+#define BOARD_MASK ((board_mask) ((1UL << BOARD_DIM) - 1))
+
+/**
+ * Compact element position, as stored in the shared adjacency table and in
+ * journal entries: a byte suffices through the 16x16 board
+ */
+#if BOARD_DIM <= 16
+typedef unsigned char board_link;
+#else
+typedef unsigned short board_link;
+#endif
+
+/**
+ * Element population counter: per-complexity counts reach BOARD_ELEMS,
+ * which only fits a byte on the 9x9 board
+ */
+#if BOARD_DIM == 9
+typedef unsigned char board_tally;
+#else
+typedef unsigned short board_tally;
+#endif
+
+
+#define ELEM_POS(x, y) (((y) * BOARD_DIM) + (x))
 
 /**
  * Get a `struct metadata`-entry from a specified location on the quadrand grid
  */
-#define BOARD_QUAD(board_ptr, x, y) (&(board_ptr)->meta_quad[TO_QUAD ((y)) + ((x) / 3)])
+#define BOARD_QUAD(board_ptr, x, y) (&(board_ptr)->meta_quad[TO_QUAD ((y)) + ((x) / BOARD_SUB)])
 
 /**
  * Get a `struct metadata`-entry from a specified row value
@@ -33,60 +105,196 @@
 /**
  * Convert any valid board position to a quadrant base position (lowest index)
  */
-#define TO_QUAD(pos) (((pos) / 3) * 3)
-
-struct board_element;
+#define TO_QUAD(pos) (((pos) / BOARD_SUB) * BOARD_SUB)
 
 typedef unsigned short int board_pos;
 typedef unsigned char element_value;
 
-/**
- * Simple definition of a board element. Vaild values range: 0-8
- * Complexity describes how many possible values would be valid for an instance
- * of a board element. For example, if it could be either 1 or 5, it would have
- * a complexity of 2. If it could hold 4, 5 or 8, it would have a complexity
- * of 3
- */
-struct board_element {
-  bool has_value : 1;                 /* Whether element has a decided value */
-
-  element_value value : 4;            /* Value of element */
-  unsigned short potential : 9;       /* Bitfield of possible values*/
-  unsigned char complexity : 4;       /* Complexity tracker */
-};
-
 /**
  * Board region metadata
  */
 struct metadata {
-  unsigned short marked : 9;          /* Which values have been marked */
+  board_mask marked : BOARD_DIM;      /* Which values have been marked */
   struct {                            /* Unique potentials */
-    unsigned char count : 2;          /* Whether or not a potential is unique */
-    unsigned char index : 3;          /* Metadata index. Context-specific */
-  } unique[9];
+    unsigned char count : 2;          /* 0, 1 or "2+" candidates for a value */
+    unsigned char index : 5;          /* Region-relative index of candidate */
+  } unique[BOARD_DIM];
 };
 
 /**
  * Board structure representing the state of a Sudoku game
- * Complexity describes how many possible values an element can legally have
  *
- * TODO: Replace elements with packed structure
+ * Element state is laid out as parallel arrays rather than an array of
+ * packed element structures: scans touch dense, homogeneous memory, copies
+ * are one memcpy of a contiguous struct, and the potential array is ready
+ * for vectorized kernels
+ *
+ * The complexity of an element describes how many possible values would be
+ * valid for it, i.e. the number of set bits of its potential mask. For
+ * example, if it could be either 1 or 5, it would have a complexity of 2
  */
 struct board {
-  /* Immediate data*/
-  struct board_element elements[81];  /* Game board */
-  unsigned char complexity : 4;       /* Complexity of simplest element */
+  /* Immediate data */
+  board_mask potential[BOARD_ELEMS];  /* Bitfield of possible values */
+  element_value value[BOARD_ELEMS];   /* Decided value, where placed */
+
+  /* Bitmap of elements with a value */
+  unsigned long long has_value[BOARD_HAS_WORDS];
+
+  /* Per-element union of the marked masks of its three regions, maintained
+     incrementally on placement so legality queries are one load */
+  board_mask forbidden[BOARD_ELEMS];
+
+  /* Per-region candidate populations: how many valueless elements of each
+     quadrant, row and column still hold each value in their potential,
+     maintained incrementally so a region losing its last candidate for an
+     unplaced value is detected the moment it happens */
+  unsigned char candidates_quad[BOARD_DIM][BOARD_DIM];
+  unsigned char candidates_row[BOARD_DIM][BOARD_DIM];
+  unsigned char candidates_col[BOARD_DIM][BOARD_DIM];
+
+  unsigned char complexity;           /* Complexity of simplest element */
+
+  /* How many valueless elements exist per complexity value, maintained
+     incrementally so refreshing board complexity never rescans the board */
+  board_tally complexity_counts[BOARD_DIM + 1];
 
   /* Metadata */
-  struct metadata meta_quad [9];      /* Quadrant metadata */
-  struct metadata meta_row  [9];      /* Row metadata */
-  struct metadata meta_col  [9];      /* Column metadata */
+  struct metadata meta_quad [BOARD_DIM];  /* Quadrant metadata */
+  struct metadata meta_row  [BOARD_DIM];  /* Row metadata */
+  struct metadata meta_col  [BOARD_DIM];  /* Column metadata */
+};
+
+
+/**
+ * Get whether the element at a given position has a decided value
+ */
+static inline bool
+board_elem_has_value (const struct board *board, unsigned pos)
+{
+  return (board->has_value[pos >> 6] >> (pos & 63)) & 1;
+}
+
+
+/**
+ * Get the complexity of the element at a given position
+ */
+static inline unsigned
+board_elem_complexity (const struct board *board, unsigned pos)
+{
+  return bits_count (board->potential[pos]);
+}
+
+
+/**
+ * Get the bitmap word of valueless element positions for the given word
+ * index, for ctz-driven iteration over empty elements
+ */
+static inline unsigned long long
+board_empty_mask (const struct board *board, unsigned word)
+{
+  unsigned long long mask = ~board->has_value[word];
+
+  /* Mask off the tail past the last element, unless it ends the word */
+  if ((BOARD_ELEMS & 63) != 0 && word == BOARD_HAS_WORDS - 1)
+    mask &= (1ULL << (BOARD_ELEMS & 63)) - 1;
+
+  return mask;
+}
+
+
+/**
+ * Shared adjacency table: for each element position, the element positions of
+ * all "connected", "adjacent" elements. The relation is identical for every
+ * board, so it is process-wide instead of a pointer table per board
+ */
+extern board_link board_links [BOARD_ELEMS][BOARD_LINK_COUNT];
+
+
+/**
+ * Kind of state recorded by a journal entry
+ */
+enum journal_kind {
+  JOURNAL_ELEM,                       /* Prior state of a board element */
+  JOURNAL_QUAD,                       /* Prior state of quadrant metadata */
+  JOURNAL_ROW,                        /* Prior state of row metadata */
+  JOURNAL_COL,                        /* Prior state of column metadata */
+  JOURNAL_CHECKPOINT                  /* Prior board-wide state at a mark */
+};
 
+/**
+ * Prior state of one mutated piece of a board, sufficient to restore it
+ */
+struct journal_entry {
+  unsigned char kind;                 /* An `enum journal_kind` value */
+  board_link index;                   /* Element position or metadata index */
+  union {
+    struct {                          /* Element state (JOURNAL_ELEM) */
+      board_mask potential;
+      element_value value;
+      bool has_value;
+    } elem;
+    struct metadata meta;             /* Metadata state (JOURNAL_*-region) */
+    struct {                          /* Board-wide state (JOURNAL_CHECKPOINT) */
+      unsigned char complexity;
+      board_tally complexity_counts[BOARD_DIM + 1];
+    } state;
+  } prev;
+};
 
-  struct board_element *links [81][20];/* All "connected", "adjacent" elements */
+/**
+ * Undo log of board mutations, allowing a failed speculative placement to be
+ * rolled back in place instead of solving on a throwaway board copy
+ */
+struct board_journal {
+  struct journal_entry *entries;      /* Journalled prior states */
+  unsigned length;                    /* Number of live entries */
+  unsigned capacity;                  /* Number of allocated entries */
 };
 
 
+/**
+ * Initialize a journal to an empty state with a default allocation
+ */
+void
+journal_init (struct board_journal *journal);
+
+
+/**
+ * Discard all entries of a journal without releasing its allocation
+ */
+void
+journal_clear (struct board_journal *journal);
+
+
+/**
+ * Release all resources held by a journal
+ */
+void
+journal_free (struct board_journal *journal);
+
+
+/**
+ * Record a rewind point capturing board-wide state and return its mark
+ *
+ * Every `journal_rewind` must target a mark produced by this function
+ */
+unsigned
+journal_checkpoint (struct board_journal *journal, const struct board *board);
+
+
+/**
+ * Restore a board to its state at the given mark, discarding all journal
+ * entries recorded since
+ */
+void
+journal_rewind (
+  struct board_journal *journal,
+  struct board *board,
+  unsigned mark
+);
+
+
 /**
  * Initialize metadata to a blank state
  */
@@ -95,10 +303,10 @@ meta_init (struct metadata *meta);
 
 
 /*
- * Just generate board element adjacency links
+ * Just generate the shared element adjacency links. Idempotent
  */
 void
-board_make_links (struct board *board);
+board_links_init (void);
 
 
 /**
@@ -205,11 +413,13 @@ board_unmark (
 
 
 /**
- * Removes a marking of a potential value of an element
+ * Removes a marking of a potential value of the element at a given position,
+ * keeping the board's complexity counts in sync
  */
 bool
 elem_unmark (
-  struct board_element *elem,
+  struct board *board,
+  board_pos pos,
   element_value value
 );
 
@@ -253,11 +463,13 @@ board_is_marked (
 
 
 /**
- * Get whether or not a given element is marked with a particular value
+ * Get whether or not the element at a given position is marked with a
+ * particular value
  */
 bool
 elem_is_marked (
-  const struct board_element *elem,
+  const struct board *board,
+  board_pos pos,
   element_value value
 );
 
@@ -306,9 +518,71 @@ board_place (
 
 
 /**
- * Place a speculative value. This allocates a duplicate board with the element
+ * Place every hidden single on the board: values that, within some row,
+ * column or quadrant, have exactly one remaining candidate element. The
+ * candidate tracking lives in the `unique` fields of the region metadata
+ *
+ * Returns the number of elements placed, or -1 if some region has an
+ * unplaced value with no remaining candidate element (a dead board)
+ */
+int
+board_place_hidden_singles (
+  struct board *board,
+  struct board_journal *journal
+);
+
+
+/**
+ * Eliminate naked pair/triple candidates in every row, column and quadrant:
+ * when N elements of a region share a potential mask of N values (N = 2 or
+ * 3), those values are confined to that subset and are unmarked from every
+ * other element of the region. Eliminations are journalled and rewind with
+ * the enclosing checkpoint
+ *
+ * Returns the number of candidates eliminated, or -1 on a dead board
+ */
+int
+board_eliminate_subsets (
+  struct board *board,
+  struct board_journal *journal
+);
+
+
+/**
+ * Attempt to set value at the given position, as `board_place`, journalling
+ * every mutation so the attempt can be rolled back in place
+ *
+ * NOTE: If this returns false, the board is left partially mutated and the
+ * caller must rewind to the checkpoint preceding the attempt
+ */
+bool
+board_place_trial (
+  struct board *board,
+  struct board_journal *journal,
+  board_pos x,
+  board_pos y,
+  element_value value
+);
+
+
+/**
+ * Remove a marking of a potential value of an element, journalling the prior
+ * element state so the removal rewinds with the enclosing checkpoint
+ */
+bool
+board_unmark_trial (
+  struct board *board,
+  struct board_journal *journal,
+  board_pos x,
+  board_pos y,
+  element_value value
+);
+
+
+/**
+ * Place a speculative value. This duplicates the board with the element
  * placed at the given location, if possible, while leaving the given board
- * untouched
+ * untouched. Fallback for callers that cannot rewind via a journal
  *
  * NOTE: If element cannot be placed, this returns NULL
  */
@@ -323,8 +597,128 @@ board_place_speculative (
 
 
 /**
- * Recomputes board complexity by searching all elements on board for the
- * lowest complexity
+ * Unchecked variants of the entry points above: identical behaviour, but
+ * no bounds or value validation and no error path. The solver's inner
+ * loops only ever produce positions and values that are valid by
+ * construction, so under OPTIMIZE the checked wrappers are compiled out
+ * and the public names below alias these directly
+ */
+bool
+board_meta_can_set_unchecked (
+  const struct board *board,
+  board_pos x,
+  board_pos y,
+  element_value value
+);
+
+void
+board_set_unchecked (
+  struct board *board,
+  board_pos x,
+  board_pos y,
+  element_value value
+);
+
+void
+board_mark_unchecked (
+  struct board *board,
+  board_pos x,
+  board_pos y,
+  element_value value
+);
+
+bool
+board_unmark_unchecked (
+  struct board *board,
+  board_pos x,
+  board_pos y,
+  element_value value
+);
+
+bool
+board_has_value_unchecked (
+  const struct board *board,
+  board_pos x,
+  board_pos y
+);
+
+element_value
+board_get_value_unchecked (
+  const struct board *board,
+  board_pos x,
+  board_pos y
+);
+
+bool
+board_is_marked_unchecked (
+  const struct board *board,
+  board_pos x,
+  board_pos y,
+  element_value value
+);
+
+void
+board_update_marks_unchecked (
+  struct board *board,
+  board_pos x,
+  board_pos y
+);
+
+bool
+board_place_unchecked (
+  struct board *board,
+  board_pos x,
+  board_pos y,
+  element_value value
+);
+
+bool
+board_place_trial_unchecked (
+  struct board *board,
+  struct board_journal *journal,
+  board_pos x,
+  board_pos y,
+  element_value value
+);
+
+bool
+board_unmark_trial_unchecked (
+  struct board *board,
+  struct board_journal *journal,
+  board_pos x,
+  board_pos y,
+  element_value value
+);
+
+struct board *
+board_place_speculative_unchecked (
+  const struct board *board,
+  struct board *board_duplicate,
+  board_pos x,
+  board_pos y,
+  element_value value
+);
+
+
+#ifdef OPTIMIZE
+#define board_meta_can_set        board_meta_can_set_unchecked
+#define board_set                 board_set_unchecked
+#define board_mark                board_mark_unchecked
+#define board_unmark              board_unmark_unchecked
+#define board_has_value           board_has_value_unchecked
+#define board_get_value           board_get_value_unchecked
+#define board_is_marked           board_is_marked_unchecked
+#define board_update_marks        board_update_marks_unchecked
+#define board_place               board_place_unchecked
+#define board_place_trial         board_place_trial_unchecked
+#define board_unmark_trial        board_unmark_trial_unchecked
+#define board_place_speculative   board_place_speculative_unchecked
+#endif
+
+
+/**
+ * Recomputes board complexity from the incrementally maintained complexity
+ * counts, without rescanning the board
  */
 bool
 board_refresh_complexity (struct board *board);
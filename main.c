@@ -1,12 +1,23 @@
 #include <errno.h>
 #include <fcntl.h>
+#include <glob.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/mman.h>
 #include <time.h>
 #include <unistd.h>
+
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+
+#include "bits.h"
 #include "board.h"
+#include "stats.h"
 
 
 /**
@@ -18,69 +29,205 @@
 
 
 /**
- * How many boards to allocate by default for board spec
- * Average depth for highly complex boards is between 10 and 12
+ * Maximum possible speculation depth: one board per element that can be
+ * placed, plus the root board. Depth can never exceed this, so the whole
+ * table is allocated up front and the search loop never touches the
+ * allocator
+ */
+#define MAX_DEPTH (BOARD_ELEMS + 1)
+
+
+/**
+ * One corpus output line: every element plus the trailing newline
+ */
+#define BOARD_LINE (BOARD_ELEMS + 1)
+
+
+/**
+ * Board values are written as the characters '1'-'9' followed by 'A'
+ * onward, so every supported size keeps one character per element ('G'
+ * caps the 16x16 board, 'P' the 25x25 one)
  */
-#define DEFAULT_DEPTH 10
+static inline char
+value_to_char (element_value value)
+{
+  return value < 9 ? (char) ('1' + value) : (char) ('A' + (value - 9));
+}
+
 
 /**
- * How many boards to allocate per depth increase
- * Higher values mean fewer reallocations, by with greater resource costs
+ * Map a value character back to its value, or -1 if it denotes none
  */
-#define DEPTH_INCREMENT 3
+static inline int
+char_to_value (char def)
+{
+  if (def >= '1' && def <= '9')
+    return def - '1';
+
+  if (BOARD_DIM > 9 && def >= 'A' && def < 'A' + (BOARD_DIM - 9))
+    return 9 + (def - 'A');
 
+  return -1;
+}
+
+
+
+/**
+ * How many queued branches to aim for per worker in parallel mode
+ * More branches mean better load balancing, at the cost of splitting the
+ * search further from the root
+ */
+#define BRANCHES_PER_WORKER 4
 
 
 struct args {
   bool valid;
+  bool batch;
+  bool pack;
+  bool stats;
+  bool trans;
+  bool count;
+  bool memo;
+  unsigned long long generate;
+  unsigned long long bench;
+  unsigned long long effort;
+  unsigned order;
   unsigned verbosity : 2;
+  unsigned jobs;
+  char *checkpoint;
   char *file_name;
 };
 
 
+/**
+ * Set by the first worker to find a solution; checked in simplify so all
+ * other workers abandon their branches
+ */
+static atomic_bool solve_cancelled = false;
+
+
+/**
+ * Effort budget, set by -eN: the maximum nodes one call into the search
+ * may expand before giving up; 0 runs unbounded. Bounds the worst-case
+ * latency of a pathological board so a pipeline can reject it as "too
+ * hard" instead of stalling a shard
+ */
+static unsigned long long effort_budget = 0;
+
+/**
+ * Whether this thread's last search stopped on its effort budget rather
+ * than exhausting the tree, so the outcome is reported as "too hard" with
+ * the effort profile accumulated so far instead of "unsolvable". Thread
+ * local so concurrent searches (-j) never read each other's verdict
+ */
+static _Thread_local bool solve_over_budget = false;
+
+
+/**
+ * Number of slots in the transposition table: 2^20 slots of 8 bytes caps
+ * the cache at 8 MiB
+ */
+#define TRANS_BITS 20
+#define TRANS_MASK ((1ULL << TRANS_BITS) - 1)
+
+
+/**
+ * Transposition table of known-dead search states, enabled by -t
+ *
+ * Each slot holds the full 64-bit hash of a board state that exhaustive
+ * search proved unsolvable, so reconverging guess orders prune the repeat
+ * subtree immediately. Verdicts depend only on the hashed state, never on
+ * which puzzle produced it, so the table is shared across batch boards and
+ * workers; writes are plain 64-bit stores, so parallel workers may drop an
+ * entry or, with hash-collision probability, prune a live branch
+ */
+static unsigned long long *trans_table = NULL;
+
+
+/**
+ * Tag distinguishing a decided value from a potential mask in hashed
+ * element states: any bit above the potential mask works
+ */
+#define HASH_VALUE_TAG (1ULL << (BOARD_DIM > 15 ? BOARD_DIM : 15))
+
+
+/**
+ * FNV-1a hash over the decided values and remaining potentials of every
+ * element
+ */
+static unsigned long long
+board_hash (const struct board *board)
+{
+  unsigned long long hash = 14695981039346656037ULL;
+
+  for (unsigned pos = 0; pos < BOARD_ELEMS; ++pos)
+  {
+    unsigned long long state =
+      board_elem_has_value (board, pos)
+        ? (HASH_VALUE_TAG | board->value[pos])
+        : board->potential[pos];
+
+    hash ^= state;
+    hash *= 1099511628211ULL;
+  }
+
+  /* Zero marks an empty slot */
+  return hash == 0 ? 1 : hash;
+}
+
+
 struct boards_table {
-  struct board **board_specs;
-  unsigned long long max_depth;
+  struct board *board_specs[MAX_DEPTH]; /* Depth-indexed views into arena */
+  struct board *arena;                  /* One contiguous allocation */
 };
 
 
+/**
+ * Allocate the full depth table as one contiguous arena, once
+ */
 void
-tables_ensure_depth (struct boards_table *board_spec, unsigned long long depth)
+tables_init (struct boards_table *board_spec)
 {
-  if (board_spec->max_depth <= depth)
-  {
-    /* Compute new max depth */
-    unsigned long long new_max;
-    if (board_spec->max_depth == 0)
-      new_max = DEFAULT_DEPTH;
-    else
-      new_max = board_spec->max_depth + DEPTH_INCREMENT;
+  board_spec->arena = malloc (sizeof (struct board) * MAX_DEPTH);
 
-    /* Disregard NULL return value. What's it gonna do, segfault? :P */
-    board_spec->board_specs = realloc (
-        board_spec->board_specs,
-        sizeof (struct board *) * new_max
-    );
+  for (unsigned long long l = 0; l < MAX_DEPTH; ++l)
+    board_spec->board_specs[l] = &board_spec->arena[l];
+}
 
-    /* Allocate boards */
-    for (unsigned long long l = board_spec->max_depth; l < new_max; ++l)
-    {
-      board_spec->board_specs[l] = malloc (sizeof (struct board));
-      board_make_links (board_spec->board_specs[l]);
-    }
 
-    /* Update max depth */
-    board_spec->max_depth = new_max;
-  }
+/**
+ * Release the depth table arena
+ */
+void
+tables_free (struct boards_table *board_spec)
+{
+  free (board_spec->arena);
+  board_spec->arena = NULL;
 }
 
+#ifdef NOVERB
+bool
+simplify (
+  struct board *board,
+  struct board_journal *journal
+);
+#else
 bool
 simplify (
-  struct boards_table *board_spec,
-  unsigned long long depth,
+  struct board *board,
+  struct board_journal *journal,
   unsigned long long *counter,
   unsigned verbosity
 );
+#endif
+
+
+static unsigned long long
+count_solutions (
+  struct board *board,
+  struct board_journal *journal,
+  unsigned long long cap
+);
 
 
 struct board_file
@@ -90,6 +237,13 @@ struct board_file
 };
 
 
+/**
+ * Size of a board-definition file: one row of value characters per board
+ * row, newline-separated, with no trailing newline required
+ */
+#define BOARD_FILE_SIZE (((BOARD_DIM + 1) * BOARD_DIM) - 1)
+
+
 /**
  * Determines if the given char is a valid character for defining
  * a board element
@@ -97,11 +251,9 @@ struct board_file
 static inline bool
 is_valid_def (char def)
 {
-  return  def == ' '    ||
-          (
-            def >= '0'  &&
-            def <= '9'
-          );
+  return  def == ' '            ||
+          def == '0'            ||
+          char_to_value (def) >= 0;
 }
 
 /**
@@ -119,8 +271,8 @@ load_board_file (const char *path)
   if (fd < 0)
     return file;
 
-  /* Map 89 bytes of file to memory */
-  void *region = mmap (NULL, 89, PROT_READ, MAP_SHARED, fd, 0);
+  /* Map the board definition to memory */
+  void *region = mmap (NULL, BOARD_FILE_SIZE, PROT_READ, MAP_SHARED, fd, 0);
   if (region == (void*)-1)
   {
     close (fd);
@@ -129,14 +281,14 @@ load_board_file (const char *path)
 
   /*
     Ensure data in file is formatted correctly:
-      1) Every 10th character is ignored (row-terminator)
-      2) Each character must be in range '0'-'9' or ' '
+      1) Every (BOARD_DIM + 1)-th character is ignored (row-terminator)
+      2) Each character must be a value character, '0' or ' '
   */
   char *data = region;
-  for (unsigned i = 1; i <= 89; ++i)
-    if (!((i % 10) == 0) && !is_valid_def (data[i - 1]))
+  for (unsigned i = 1; i <= BOARD_FILE_SIZE; ++i)
+    if (!((i % (BOARD_DIM + 1)) == 0) && !is_valid_def (data[i - 1]))
     {
-      munmap (region, 89);
+      munmap (region, BOARD_FILE_SIZE);
       close (fd);
       return file;
     }
@@ -155,7 +307,7 @@ static void
 close_board_file (struct board_file file)
 {
   close (file.fd);
-  munmap (file.data, 89);
+  munmap (file.data, BOARD_FILE_SIZE);
 }
 
 static void
@@ -165,313 +317,2912 @@ copy_to_board (struct board_file file, struct board *board)
   board_init (board);
 
   char *data = file.data;
-  for (unsigned i = 1; i <= 89; ++i)
-    if ((i % 10) != 0)
+  for (unsigned i = 1; i <= BOARD_FILE_SIZE; ++i)
+    if ((i % (BOARD_DIM + 1)) != 0)
     {
-      board_pos x = i % 10;
-      board_pos y = i / 10;
+      board_pos x = i % (BOARD_DIM + 1);
+      board_pos y = i / (BOARD_DIM + 1);
 
       if (data[i - 1] != ' ')
-        board_place (board, x - 1, y, data[i - 1] - '0' - 1);
+        board_place (
+            board, x - 1, y, (element_value) char_to_value (data[i - 1])
+        );
     }
 }
 
 
-static void
-ansi_set_cursor (unsigned y, unsigned x)
+/**
+ * Packed binary corpus format: an 8-byte magic header followed by fixed-size
+ * records, each holding the element values of one board (0 = empty,
+ * 1-BOARD_DIM = given). The 9x9 format packs two values per byte as
+ * consecutive nibbles, low nibble first, with the final nibble of a record
+ * unused; wider boards store one value per byte
+ */
+#define CORPUS_MAGIC "SDKBIN\r\n"
+#define CORPUS_MAGIC_LENGTH 8
+#if BOARD_DIM == 9
+#define CORPUS_RECORD_SIZE 41
+#else
+#define CORPUS_RECORD_SIZE BOARD_ELEMS
+#endif
+
+/**
+ * Capacity for one corpus text line: the board plus a generator grade
+ */
+#define CORPUS_LINE_CAPACITY (BOARD_ELEMS + 47)
+
+
+/**
+ * Read one element value of a corpus record
+ */
+static inline unsigned
+record_get_value (const unsigned char *record, unsigned i)
 {
-  printf ("\033[%u;%uH", x + 1, y + 1);
+#if BOARD_DIM == 9
+  return (record[i >> 1] >> ((i & 1) * 4)) & 0xF;
+#else
+  return record[i];
+#endif
 }
 
 
-static void
-ansi_clear_screen ()
+/**
+ * Write one element value into a zeroed corpus record
+ */
+static inline void
+record_set_value (unsigned char *record, unsigned i, unsigned value)
 {
-  puts (CLEAR);
+#if BOARD_DIM == 9
+  record[i >> 1] |= (unsigned char) (value << ((i & 1) * 4));
+#else
+  record[i] = (unsigned char) value;
+#endif
 }
 
 
-void
-ansi_cursor_show (bool show)
+/**
+ * Render a board as a batch-mode puzzle line, with '.' marking any element
+ * that still lacks a decided value
+ */
+static void
+render_board_line (const struct board *board, char line[BOARD_LINE])
 {
-  if (show)
-    fputs("\e[?25h", stdout);
-  else
-    fputs("\e[?25l", stdout);
+  for (unsigned i = 0; i < BOARD_ELEMS; ++i)
+    if (board_has_value (board, i % BOARD_DIM, i / BOARD_DIM))
+      line[i] = value_to_char (
+          board_get_value (board, i % BOARD_DIM, i / BOARD_DIM)
+      );
+    else
+      line[i] = '.';
+
+  line[BOARD_ELEMS] = '\n';
 }
 
+
+/**
+ * Print a board as a batch-mode puzzle line
+ */
 static void
-print_board_verbose (
-  const struct board *board,
-  unsigned whence_x,
-  unsigned whence_y
-)
+print_board_line (const struct board *board)
 {
-  for (board_pos y = 0; y < 9; ++y)
+  char line[BOARD_LINE];
+
+  render_board_line (board, line);
+  fwrite (line, 1, sizeof line, stdout);
+}
+
+
+/**
+ * Load a packed corpus record into a board
+ *
+ * Returns false if the record holds an out-of-range value or describes an
+ * impossible board
+ */
+static bool
+copy_packed_to_board (const unsigned char *record, struct board *board)
+{
+  for (unsigned i = 0; i < BOARD_ELEMS; ++i)
   {
-    for (board_pos x = 0; x < 9; ++x)
-    {
-      for (element_value vy = 0; vy < 3; ++vy)
-        for (element_value vx = 0; vx < 3; ++vx)
-        {
-          element_value check = vx + (vy * 3);
+    unsigned value = record_get_value (record, i);
 
-          ansi_set_cursor (whence_x + (x * 4) + vx, whence_y + (y * 4) + vy);
-          
-          if (board_has_value (board, x, y))
-            printf ("%u", board_get_value (board, x, y) + 1);
-          else if (board_is_marked (board, x, y, check))
-            printf (COLOUR_RED "%u" COLOUR_RESET, check + 1);
-          else
-            fputs (" ", stdout);
+    if (value > BOARD_DIM)
+      return false;
 
-          if (vx == 2 && x != 8)
-            fputs ("|", stdout);
-        }
-    }
-    
-    ansi_set_cursor (0, (y * 4) + 3);
-    if (y != 8)
-    {
-      for (unsigned i = 0; i < (4 * 9) - 1; ++i)
-        if ((i + 1) % 4 == 0)
-          fputs ("+", stdout);
-        else
-          fputs ("-", stdout);
-    }
+    if (value != 0 &&
+        ! board_place (board, i % BOARD_DIM, i / BOARD_DIM, value - 1))
+      return false;
   }
 
-  fflush (stdout);
+  return true;
 }
 
 
-static void
-print_board (const struct board *board, const struct board *compare, unsigned whence_x, unsigned whence_y)
+/**
+ * Solution memoization across a batch, enabled by -m: grading corpora hold
+ * many near-duplicate puzzles (the same grid with holes dug in different
+ * orders), and any complete grid solves every puzzle whose givens agree
+ * with it. Recent distinct solutions are kept in a small ring; an incoming
+ * board is checked against them most-recent-first, one compare per element
+ * and entry, and answered from the cache on a match instead of searched
+ *
+ * Entries are deduplicated by the same 64-bit hash the transposition table
+ * uses, applied to the solved grid. Lookups return any matching solution,
+ * so a puzzle with several solutions may get a different (equally valid)
+ * one than an uncached run; solution counting never consults the cache
+ */
+#define MEMO_SOLUTIONS 64
+
+struct memo_entry {
+  unsigned long long hash;            /* board_hash of the solved grid */
+  unsigned char values[BOARD_ELEMS];
+};
+
+static struct memo_entry memo_cache[MEMO_SOLUTIONS];
+static unsigned memo_count = 0;
+static unsigned memo_next = 0;
+static bool memo_enabled = false;
+
+
+/**
+ * Find a cached solution whose grid agrees with every given of the board
+ */
+static const unsigned char *
+memo_lookup (const struct board *board)
 {
-  for (board_pos y = 0; y < 9; ++y)
+  for (unsigned probe = 0; probe < memo_count; ++probe)
   {
-    /* Print row */
-    for (board_pos x = 0; x < 9; ++x)
-    {
-      ansi_set_cursor (whence_x + (x * 2), whence_y + (y * 2));
+    const struct memo_entry *entry =
+      &memo_cache[(memo_next + MEMO_SOLUTIONS - 1 - probe) % MEMO_SOLUTIONS];
 
-      /* Print board element */
-      if (board_has_value (board, x, y))
-      {
-        if (compare != NULL && ! board_has_value (compare, x, y))
-          printf (COLOUR_RED "%u" COLOUR_RESET, board_get_value (board, x, y) + 1);
-        else
-          printf ("%u", board_get_value (board, x, y) + 1);
-      }
-      else
-        fputs (" ", stdout);
+    bool match = true;
+    for (unsigned pos = 0; pos < BOARD_ELEMS && match; ++pos)
+      if (board_elem_has_value (board, pos) &&
+          board->value[pos] != entry->values[pos])
+        match = false;
 
-      /* Print column element delimiter */
-      if (x < 8)
-        fputs("|", stdout);
-    }
-    
-    /* Print row element delimiter */
-    if (y < 8)
-    {
-      for (board_pos x = 0; x < 17; ++x)
-      {
-        ansi_set_cursor (whence_x + x, whence_y + (y * 2 + 1));
-        if ((x & 1) == 0)
-          fputs ("-", stdout);
-        else
-          fputs ("+", stdout);
-      }
-    }
+    if (match)
+      return entry->values;
   }
+
+  return NULL;
 }
 
 
 /**
- * Compute first potential value of a given element
+ * Insert a solved grid into the cache unless an identical one is present
  */
-element_value
-first_potential_value (struct board_element *element, struct board *board, bool *error)
+static void
+memo_store (const unsigned char values[BOARD_ELEMS])
 {
-  unsigned short potential = element->potential;
-  if (potential == 0)
+  /* The hash of a solved grid, exactly as board_hash computes it */
+  unsigned long long hash = 14695981039346656037ULL;
+  for (unsigned pos = 0; pos < BOARD_ELEMS; ++pos)
   {
-    *error = true;
-    return 0;
+    hash ^= HASH_VALUE_TAG | values[pos];
+    hash *= 1099511628211ULL;
   }
+  if (hash == 0)
+    hash = 1;
 
-  *error = false;
-  
-  element_value value = 0;
-  while (potential != 0)
-  {
-    if ((potential & 1) == 1)
-      return value;
-    ++value;
-    potential >>= 1;
-  }
-  
-  /* Unreachable */
-  abort();
+  for (unsigned probe = 0; probe < memo_count; ++probe)
+    if (memo_cache[probe].hash == hash)
+      return;
+
+  memo_cache[memo_next].hash = hash;
+  memcpy (memo_cache[memo_next].values, values, BOARD_ELEMS);
+
+  memo_next = (memo_next + 1) % MEMO_SOLUTIONS;
+  if (memo_count < MEMO_SOLUTIONS)
+    ++memo_count;
 }
 
 
 /**
- * Reduce away all elements on board with complexity=1 until none remain
+ * Solve one already-loaded batch board and emit its solution line
  */
-#ifdef NOVERB
-bool
-simplify (
-  struct boards_table *board_specs,
-  unsigned long long depth
-)
-#else
-bool
-simplify (
-  struct boards_table *board_specs,
-  unsigned long long depth,
-  unsigned long long *counter,
-  unsigned verbosity
+static void
+solve_batch_board (
+  struct board *root_board,
+  struct board_journal *journal,
+  unsigned long long board_number
 )
-#endif
 {
-  /* Get current table */
-  struct board *board = board_specs->board_specs[depth];
+  unsigned long long counter = 0;
 
-#ifndef NOVERB
-  if (verbosity > 0)
+  ++solve_stats.boards;
+
+  if (memo_enabled)
   {
-    if (((*counter) & (0xFFFF >> (4 * (4 - verbosity)))) == 0)
+    const unsigned char *memo = memo_lookup (root_board);
+
+    if (memo != NULL)
     {
-      print_board_verbose (board, 0, 0);
-      ansi_set_cursor (0, 35);
-      printf ("Iteration: %llu", *counter);
+      ++solve_stats.memo_hits;
+
+      char line[BOARD_LINE];
+      for (unsigned pos = 0; pos < BOARD_ELEMS; ++pos)
+        line[pos] = value_to_char (memo[pos]);
+      line[BOARD_ELEMS] = '\n';
+
+      fwrite (line, 1, sizeof line, stdout);
+      return;
     }
-    *counter += 1;
   }
-#endif
 
+  board_refresh_complexity (root_board);
+  journal_clear (journal);
+
+  unsigned long long nodes_before = solve_stats.nodes;
+  unsigned long long guesses_before = solve_stats.guesses;
 
-  bool error;
+  clock_t start_clk = clock ();
+
+  /* An invalid board short-circuits past the search, which would leave a
+     previous board's budget verdict standing */
+  solve_over_budget = false;
 
-  unsigned count = 0;
+  bool solved =
+    board_is_valid (root_board) &&
+    simplify (root_board, journal, &counter, 0) &&
+    root_board->complexity == 0;
 
-  /* Reduce using low-complexity computation */
-  while (board->complexity == 1)
+  if (! solved)
   {
-    for (board_pos y = 0; y < 9; ++y)
-      for (board_pos x = 0; x < 9; ++x)
-        if (! board_has_value (board, x, y))
-        {
-          struct board_element *elem = BOARD_ELEM (board, x, y);
-          if (elem->complexity == 1)
-          {
-            element_value value = first_potential_value (elem, board, &error);
-            if (error) return false;
+    if (solve_over_budget)
+      fprintf (
+          stderr,
+          "Budget exceeded for board %llu (nodes=%llu guesses=%llu)\n",
+          board_number,
+          solve_stats.nodes - nodes_before,
+          solve_stats.guesses - guesses_before
+      );
+    else
+      fprintf (stderr, "No solution for board %llu\n", board_number);
+  }
+  else if (memo_enabled)
+    memo_store (root_board->value);
 
-            ++count;
+  solve_stats.solve_time +=
+    ((long double) (clock () - start_clk)) / CLOCKS_PER_SEC;
 
-            if (! board_place (board, x, y, value))
-              return false;
-          }
-        }
+  print_board_line (root_board);
+}
 
-    board_refresh_complexity (board);
-  }
 
-  /* Attempt to reduce with speculative placement */
-  if (board->complexity > 1)
-  {
-    for (board_pos y = 0; y < 9; ++y)
-      for (board_pos x = 0; x < 9; ++x)
-      {
-        struct board_element *elem = BOARD_ELEM (board, x, y);
-        /* Find a simplest element on the board */
-        if (
-            ! elem->has_value &&
-            elem->complexity == board->complexity
-        )
-          for (element_value value = 0; value < 9; ++value)
-          {
-            /* Try speculative placement of each potential value and recurse */
-            tables_ensure_depth (board_specs, depth + 1);
-            if (elem_is_marked (elem, value))
-            {
-              struct board *board_spec =
-                board_place_speculative (
-                  board,
-                  board_specs->board_specs[depth + 1],
-                  x,
-                  y,
-                  value
-                );
-
-              /* If speculative placement failed, try another value */
-              if (board_spec == NULL)
-              {
-                if (! elem_unmark (elem, value))
-                  return false;
-                continue;
-              }
+/**
+ * Count the solutions (capped at 2) of one already-loaded batch board and
+ * emit the count as its output line
+ */
+static void
+count_batch_board (
+  struct board *root_board,
+  struct board_journal *journal
+)
+{
+  board_refresh_complexity (root_board);
+  journal_clear (journal);
 
-              /* Found solution */
+  ++solve_stats.boards;
+  clock_t start_clk = clock ();
 
-              if (
-#ifdef NOVERB
-                  simplify (
-                    board_specs,
-                    depth + 1
-                  ) &&
-#else
-                  simplify (
-                    board_specs,
-                    depth + 1,
-                    counter,
-                    verbosity
-                  ) &&
-#endif
-                  board_spec->complexity == 0)
-              {
-                board_copy (board_spec, board);
-                x = 9;
-                y = 9;
-                value = 9;
-              }
-              else if (! elem_unmark (elem, value))
-                return false;
-            }
-          }
-      }
-  }
-  return true;
+  solve_over_budget = false;
+
+  unsigned long long solutions =
+    board_is_valid (root_board)
+      ? count_solutions (root_board, journal, 2)
+      : 0;
+
+  solve_stats.solve_time +=
+    ((long double) (clock () - start_clk)) / CLOCKS_PER_SEC;
+
+  /* A count cut short by the effort budget is neither 0 nor exact, so it
+     gets a verdict distinct from any real count */
+  if (solve_over_budget)
+    puts ("?");
+  else
+    printf ("%llu\n", solutions);
 }
 
 
-struct args
-argparse (int argc, char **argv)
-{
-  struct args result;
-  result.file_name = NULL;
-  result.valid = true;
-  result.verbosity = 0;
-  if (argc < 2)
-  {
-    result.valid = false;
-    return result;
-  }
+#if defined (__SSE2__) && BOARD_DIM == 9
 
-  for (int i = 1; i < argc; ++i)
-    if (strncmp (argv[i], "-", 1) == 0)
+/**
+ * Wide lockstep solving: boards are interleaved as one 16-bit lane per
+ * board, so one vector load touches the same element of every board in a
+ * group and the naked-singles propagation loop runs across the whole group
+ * at once. Boards that stall (needing hidden singles or speculation), die
+ * or fail to load drop out of lockstep and are redone on the scalar path
+ *
+ * The lane layout is married to the 9x9 board's 16-bit masks, so wider
+ * builds solve every board on the scalar path instead
+ */
+#ifdef __AVX2__
+
+#define WIDE_LANES 16
+typedef __m256i wide_vec;
+#define wide_load(ptr)      _mm256_loadu_si256 ((const __m256i *) (ptr))
+#define wide_store(ptr, v)  _mm256_storeu_si256 ((__m256i *) (ptr), (v))
+#define wide_and            _mm256_and_si256
+#define wide_or             _mm256_or_si256
+#define wide_andnot         _mm256_andnot_si256
+#define wide_cmpeq          _mm256_cmpeq_epi16
+#define wide_sub            _mm256_sub_epi16
+#define wide_zero           _mm256_setzero_si256
+#define wide_one()          _mm256_set1_epi16 (1)
+#define wide_movemask       _mm256_movemask_epi8
+
+#else
+
+#define WIDE_LANES 8
+typedef __m128i wide_vec;
+#define wide_load(ptr)      _mm_loadu_si128 ((const __m128i *) (ptr))
+#define wide_store(ptr, v)  _mm_storeu_si128 ((__m128i *) (ptr), (v))
+#define wide_and            _mm_and_si128
+#define wide_or             _mm_or_si128
+#define wide_andnot         _mm_andnot_si128
+#define wide_cmpeq          _mm_cmpeq_epi16
+#define wide_sub            _mm_sub_epi16
+#define wide_zero           _mm_setzero_si128
+#define wide_one()          _mm_set1_epi16 (1)
+#define wide_movemask       _mm_movemask_epi8
+
+#endif
+
+
+/**
+ * One group of boards in lockstep layout: element `pos` of board `lane`
+ * lives at `potential[pos][lane]`, so each `[pos]` row is one vector
+ */
+struct wide_group {
+  unsigned short potential[81][WIDE_LANES];
+  unsigned short valued[81][WIDE_LANES]; /* 0xFFFF where a lane decided */
+  unsigned short active[WIDE_LANES];     /* 0xFFFF while in lockstep */
+  unsigned char filled[WIDE_LANES];      /* Decided elements per lane */
+};
+
+
+/**
+ * Scatter a loaded scalar board into one lane of a lockstep group
+ */
+static void
+wide_group_load_lane (
+  struct wide_group *group,
+  unsigned lane,
+  const struct board *board
+)
+{
+  group->active[lane] = 0xFFFF;
+
+  for (unsigned pos = 0; pos < 81; ++pos)
+    if (board_elem_has_value (board, pos))
+    {
+      group->potential[pos][lane] = 1 << board->value[pos];
+      group->valued[pos][lane] = 0xFFFF;
+      ++(group->filled[lane]);
+    }
+    else
+      group->potential[pos][lane] = board->potential[pos];
+}
+
+
+/**
+ * Run naked-singles propagation across all active lanes of a group until
+ * no lane makes progress, masking lanes off as they die
+ *
+ * Returns the set of lanes that propagated to a full board
+ */
+static unsigned
+wide_group_propagate (struct wide_group *group)
+{
+  bool progress = true;
+
+  while (progress)
+  {
+    progress = false;
+
+    for (unsigned pos = 0; pos < 81; ++pos)
+    {
+      wide_vec v = wide_load (group->potential[pos]);
+      wide_vec undecided = wide_andnot (
+          wide_load (group->valued[pos]),
+          wide_load (group->active)
+      );
+      wide_vec none = wide_cmpeq (v, wide_zero ());
+
+      /* Lanes whose element lost its last candidate are dead */
+      int dead = wide_movemask (wide_and (none, undecided));
+      if (dead != 0)
+        for (unsigned lane = 0; lane < WIDE_LANES; ++lane)
+          if ((dead >> (lane * 2)) & 1)
+            group->active[lane] = 0;
+
+      /* Undecided elements whose potential is a nonzero power of two */
+      wide_vec single = wide_and (
+          wide_cmpeq (wide_and (v, wide_sub (v, wide_one ())), wide_zero ()),
+          wide_andnot (none, undecided)
+      );
+
+      int mask = wide_movemask (single);
+      if (mask == 0)
+        continue;
+
+      wide_store (
+          group->valued[pos],
+          wide_or (wide_load (group->valued[pos]), single)
+      );
+
+      /* Clear the placed bits from every adjacent element, lanewise */
+      wide_vec bits = wide_and (v, single);
+      for (unsigned i = 0; i < 20; ++i)
+      {
+        unsigned peer = board_links[pos][i];
+
+        wide_store (
+            group->potential[peer],
+            wide_andnot (bits, wide_load (group->potential[peer]))
+        );
+      }
+
+      for (unsigned lane = 0; lane < WIDE_LANES; ++lane)
+        if ((mask >> (lane * 2)) & 1)
+        {
+          ++(group->filled[lane]);
+          ++solve_stats.singles;
+        }
+
+      progress = true;
+    }
+  }
+
+  unsigned solved = 0;
+  for (unsigned lane = 0; lane < WIDE_LANES; ++lane)
+    if (group->active[lane] != 0 && group->filled[lane] == 81)
+      solved |= 1u << lane;
+
+  return solved;
+}
+
+
+/**
+ * Check that a fully propagated lane is a valid solution: every region
+ * must cover all nine values. Lockstep placement cannot see two elements
+ * of a region reduced to the same single in one sweep, which only happens
+ * on unsolvable boards, so those are demoted to the scalar path here
+ */
+static bool
+wide_lane_solution_valid (const struct wide_group *group, unsigned lane)
+{
+  for (unsigned region = 0; region < 9; ++region)
+  {
+    unsigned short row = 0;
+    unsigned short col = 0;
+    unsigned short quad = 0;
+
+    for (unsigned i = 0; i < 9; ++i)
+    {
+      row |= group->potential[(region * 9) + i][lane];
+      col |= group->potential[(i * 9) + region][lane];
+      quad |= group->potential[
+          ((region / 3) * 27) + ((region % 3) * 3) + ((i / 3) * 9) + (i % 3)
+      ][lane];
+    }
+
+    if (row != 0x1FF || col != 0x1FF || quad != 0x1FF)
+      return false;
+  }
+
+  return true;
+}
+
+
+/**
+ * Solve a corpus in lockstep groups: boards that propagate to a valid
+ * solution with naked singles alone are emitted straight from the group;
+ * stragglers are reloaded and solved on the scalar path, which also
+ * reports bad and unsolvable boards exactly as the narrow loop would
+ */
+static void
+solve_batch_wide (
+  const unsigned char *records,
+  unsigned long long record_count,
+  const struct board *blank,
+  struct board *root_board,
+  struct board_journal *journal
+)
+{
+  struct wide_group group;
+  unsigned char memo_values[WIDE_LANES][81];
+  unsigned memo_mask;
+
+  for (unsigned long long base = 0; base < record_count; base += WIDE_LANES)
+  {
+    unsigned lanes = WIDE_LANES;
+    if (record_count - base < lanes)
+      lanes = record_count - base;
+
+    memset (&group, 0, sizeof group);
+    memo_mask = 0;
+
+    for (unsigned lane = 0; lane < lanes; ++lane)
+    {
+      board_copy (blank, root_board);
+
+      if (copy_packed_to_board (
+              records + ((base + lane) * CORPUS_RECORD_SIZE),
+              root_board
+          ))
+      {
+        /* A cached solution short-circuits the lane entirely */
+        if (memo_enabled)
+        {
+          const unsigned char *memo = memo_lookup (root_board);
+
+          if (memo != NULL)
+          {
+            memcpy (memo_values[lane], memo, 81);
+            memo_mask |= 1u << lane;
+            continue;
+          }
+        }
+
+        wide_group_load_lane (&group, lane, root_board);
+      }
+    }
+
+    clock_t start_clk = clock ();
+    unsigned solved = wide_group_propagate (&group);
+    solve_stats.solve_time +=
+      ((long double) (clock () - start_clk)) / CLOCKS_PER_SEC;
+
+    for (unsigned lane = 0; lane < lanes; ++lane)
+    {
+      unsigned long long index = base + lane;
+      char line[82];
+
+      if (((memo_mask >> lane) & 1) != 0)
+      {
+        ++solve_stats.boards;
+        ++solve_stats.memo_hits;
+
+        for (unsigned pos = 0; pos < 81; ++pos)
+          line[pos] = (char) ('1' + memo_values[lane][pos]);
+        line[81] = '\n';
+
+        fwrite (line, 1, sizeof line, stdout);
+        continue;
+      }
+
+      if (((solved >> lane) & 1) != 0 &&
+          wide_lane_solution_valid (&group, lane))
+      {
+        ++solve_stats.boards;
+
+        unsigned char values[81];
+        for (unsigned pos = 0; pos < 81; ++pos)
+          values[pos] = (unsigned char) bits_first (group.potential[pos][lane]);
+
+        if (memo_enabled)
+          memo_store (values);
+
+        for (unsigned pos = 0; pos < 81; ++pos)
+          line[pos] = (char) ('1' + values[pos]);
+        line[81] = '\n';
+
+        fwrite (line, 1, sizeof line, stdout);
+        continue;
+      }
+
+      board_copy (blank, root_board);
+
+      if (! copy_packed_to_board (records + (index * CORPUS_RECORD_SIZE),
+                                  root_board))
+      {
+        fprintf (stderr, "Bad board %llu\n", index + 1);
+        print_board_line (root_board);
+      }
+      else
+        solve_batch_board (root_board, journal, index + 1);
+    }
+  }
+}
+
+#endif /* __SSE2__ && BOARD_DIM == 9 */
+
+
+/**
+ * How far ahead of the flushed output workers may run in parallel batch
+ * mode; each in-flight slot buffers one solution line
+ */
+#define REORDER_WINDOW 1024
+
+
+/**
+ * Shared state of one parallel batch run
+ *
+ * Workers claim puzzle indices from `next_claim` and solve with purely
+ * thread-local boards and journals; the only shared mutation in the solve
+ * path is the lock-free claim. Finished lines pass through a small reorder
+ * ring so output stays in input order
+ */
+struct batch_shared {
+  const unsigned char *records;       /* Packed corpus records */
+  unsigned long long record_count;
+  const struct board *blank;          /* Pristine board to reset from */
+  bool count;                         /* Count solutions instead of solving */
+
+  atomic_ullong next_claim;           /* Next unclaimed puzzle index */
+
+  /* Reorder ring, guarded by `lock` */
+  unsigned long long next_flush;      /* Next index to write out */
+  char (*lines)[BOARD_LINE];
+  unsigned char *lengths;
+  bool *ready;
+  pthread_mutex_t lock;
+  pthread_cond_t slot_free;           /* Flusher recycled a slot */
+  pthread_cond_t slot_ready;          /* Worker completed a slot */
+};
+
+
+/**
+ * Load a record and solve or count it on the given thread-local board,
+ * rendering the output line and returning its length
+ */
+static unsigned
+solve_batch_record (
+  const struct batch_shared *shared,
+  unsigned long long index,
+  struct board *root_board,
+  struct board_journal *journal,
+  char line[BOARD_LINE]
+)
+{
+  unsigned long long counter = 0;
+
+  board_copy (shared->blank, root_board);
+
+  bool loaded = copy_packed_to_board (
+      shared->records + (index * CORPUS_RECORD_SIZE),
+      root_board
+  );
+
+  if (! loaded)
+    fprintf (stderr, "Bad board %llu\n", index + 1);
+  else
+  {
+    ++solve_stats.boards;
+    board_refresh_complexity (root_board);
+  }
+
+  if (shared->count)
+  {
+    solve_over_budget = false;
+
+    unsigned long long solutions =
+      loaded && board_is_valid (root_board)
+        ? count_solutions (root_board, journal, 2)
+        : 0;
+
+    journal_clear (journal);
+
+    /* A count cut short by the effort budget is neither 0 nor exact */
+    if (solve_over_budget)
+      return (unsigned) snprintf (line, BOARD_LINE, "?\n");
+
+    return (unsigned) snprintf (line, BOARD_LINE, "%llu\n", solutions);
+  }
+
+  solve_over_budget = false;
+
+  unsigned long long nodes_before = solve_stats.nodes;
+  unsigned long long guesses_before = solve_stats.guesses;
+
+  if (loaded &&
+      ! (board_is_valid (root_board) &&
+         simplify (root_board, journal, &counter, 0) &&
+         root_board->complexity == 0))
+  {
+    /* The profile deltas are approximate under -j, like every counter in
+       the shared stats (see stats.h); the verdict itself is exact */
+    if (solve_over_budget)
+      fprintf (
+          stderr,
+          "Budget exceeded for board %llu (nodes=%llu guesses=%llu)\n",
+          index + 1,
+          solve_stats.nodes - nodes_before,
+          solve_stats.guesses - guesses_before
+      );
+    else
+      fprintf (stderr, "No solution for board %llu\n", index + 1);
+  }
+
+  render_board_line (root_board, line);
+  journal_clear (journal);
+
+  return BOARD_LINE;
+}
+
+
+/**
+ * Batch worker loop: claim puzzles, solve them with thread-local state and
+ * publish the solution lines to the reorder ring
+ */
+static void *
+batch_worker (void *arg)
+{
+  struct batch_shared *shared = arg;
+
+  struct board root_board;
+  struct board_journal journal;
+  char line[BOARD_LINE];
+
+  journal_init (&journal);
+
+  for (;;)
+  {
+    unsigned long long index = atomic_fetch_add (&shared->next_claim, 1);
+    if (index >= shared->record_count)
+      break;
+
+    /* Stay within the reorder window of the flusher */
+    pthread_mutex_lock (&shared->lock);
+    while (index >= shared->next_flush + REORDER_WINDOW)
+      pthread_cond_wait (&shared->slot_free, &shared->lock);
+    pthread_mutex_unlock (&shared->lock);
+
+    unsigned length =
+      solve_batch_record (shared, index, &root_board, &journal, line);
+
+    /* Publish the finished line */
+    pthread_mutex_lock (&shared->lock);
+    memcpy (shared->lines[index % REORDER_WINDOW], line, sizeof line);
+    shared->lengths[index % REORDER_WINDOW] = length;
+    shared->ready[index % REORDER_WINDOW] = true;
+    pthread_cond_broadcast (&shared->slot_ready);
+    pthread_mutex_unlock (&shared->lock);
+  }
+
+  journal_free (&journal);
+
+  return NULL;
+}
+
+
+/**
+ * Solve a packed record array with a pool of `jobs` workers, writing
+ * solution lines to stdout in input order
+ */
+static void
+solve_batch_parallel (
+  const unsigned char *records,
+  unsigned long long record_count,
+  const struct board *blank,
+  unsigned jobs,
+  bool count
+)
+{
+  struct batch_shared shared;
+
+  shared.records = records;
+  shared.record_count = record_count;
+  shared.count = count;
+  shared.blank = blank;
+  atomic_init (&shared.next_claim, 0);
+  shared.next_flush = 0;
+  shared.lines = malloc (sizeof (*shared.lines) * REORDER_WINDOW);
+  shared.lengths = malloc (REORDER_WINDOW);
+  shared.ready = calloc (REORDER_WINDOW, sizeof (bool));
+  pthread_mutex_init (&shared.lock, NULL);
+  pthread_cond_init (&shared.slot_free, NULL);
+  pthread_cond_init (&shared.slot_ready, NULL);
+
+  pthread_t *workers = malloc (sizeof (pthread_t) * jobs);
+
+  for (unsigned i = 0; i < jobs; ++i)
+    pthread_create (&workers[i], NULL, batch_worker, &shared);
+
+  /* Flush completed lines in input order */
+  pthread_mutex_lock (&shared.lock);
+  while (shared.next_flush < record_count)
+  {
+    unsigned slot = shared.next_flush % REORDER_WINDOW;
+
+    while (! shared.ready[slot])
+      pthread_cond_wait (&shared.slot_ready, &shared.lock);
+
+    char line[BOARD_LINE];
+    unsigned length = shared.lengths[slot];
+    memcpy (line, shared.lines[slot], sizeof line);
+    shared.ready[slot] = false;
+    ++(shared.next_flush);
+    pthread_cond_broadcast (&shared.slot_free);
+
+    pthread_mutex_unlock (&shared.lock);
+    fwrite (line, 1, length, stdout);
+    pthread_mutex_lock (&shared.lock);
+  }
+  pthread_mutex_unlock (&shared.lock);
+
+  for (unsigned i = 0; i < jobs; ++i)
+    pthread_join (workers[i], NULL);
+
+  free (workers);
+  free (shared.lines);
+  free (shared.lengths);
+  free (shared.ready);
+  pthread_mutex_destroy (&shared.lock);
+  pthread_cond_destroy (&shared.slot_free);
+  pthread_cond_destroy (&shared.slot_ready);
+}
+
+
+/**
+ * Solve a stream of puzzles, reusing one depth table allocation for the
+ * whole batch. The input is either a text file with one puzzle line per
+ * board, or a packed binary corpus (detected by its magic header) that is
+ * mmapped whole so the solve loop costs no per-puzzle syscalls; text corpora
+ * are packed into an in-memory record array up front so both forms share one
+ * solve loop. With jobs > 1 the records are distributed to a worker pool
+ *
+ * Solutions are written to stdout in input order; malformed or impossible
+ * boards are reported on stderr and emitted as their (partial) input state
+ */
+static int
+solve_batch (const char *path, bool stats, unsigned jobs, bool count, bool memo)
+{
+  /* The cache is unlocked shared state and never sound for counting, so
+     memoization covers sequential solving only */
+  memo_enabled = memo && jobs == 1 && ! count;
+
+  FILE *batch = fopen (path, "r");
+  if (batch == NULL)
+  {
+    fprintf (stderr, "Could not open batch file: %s\n", path);
+    return 1;
+  }
+
+  /* Allocate depth table and a pristine board to cheaply reset from */
+  struct boards_table boards;
+  tables_init (&boards);
+
+  struct board blank;
+  board_init (&blank);
+
+  struct board_journal journal;
+  journal_init (&journal);
+
+  struct board *root_board = boards.board_specs[0];
+
+  int result = 0;
+
+  const unsigned char *records = NULL;
+  unsigned long long record_count = 0;
+  void *region = NULL;
+  long region_size = 0;
+  unsigned char *packed = NULL;
+
+  char magic[CORPUS_MAGIC_LENGTH];
+  if (
+      fread (magic, 1, sizeof magic, batch) == sizeof magic &&
+      memcmp (magic, CORPUS_MAGIC, sizeof magic) == 0
+  )
+  {
+    /* Packed corpus: map the whole file and walk it in memory */
+    if (fseek (batch, 0, SEEK_END) == 0)
+      region_size = ftell (batch);
+
+    if (region_size > (long) CORPUS_MAGIC_LENGTH)
+      region =
+        mmap (NULL, region_size, PROT_READ, MAP_SHARED, fileno (batch), 0);
+
+    if (region == NULL || region == (void *) -1)
+    {
+      fprintf (stderr, "Could not map packed corpus: %s\n", path);
+      region = NULL;
+      result = 1;
+    }
+    else
+    {
+      records = (const unsigned char *) region + CORPUS_MAGIC_LENGTH;
+      record_count = (region_size - CORPUS_MAGIC_LENGTH) / CORPUS_RECORD_SIZE;
+    }
+  }
+  else
+  {
+    /* Text corpus: pack every line into an in-memory record array */
+    rewind (batch);
+
+    char line[CORPUS_LINE_CAPACITY];
+    unsigned long long capacity = 64;
+
+    packed = malloc (capacity * CORPUS_RECORD_SIZE);
+
+    while (fgets (line, sizeof line, batch) != NULL)
+    {
+      /* Skip blank separator lines */
+      if (line[0] == '\n')
+        continue;
+
+      if (record_count == capacity)
+      {
+        capacity *= 2;
+        packed = realloc (packed, capacity * CORPUS_RECORD_SIZE);
+      }
+
+      unsigned char *record = packed + (record_count * CORPUS_RECORD_SIZE);
+      memset (record, 0, CORPUS_RECORD_SIZE);
+
+      bool valid = true;
+      for (unsigned i = 0; i < BOARD_ELEMS && valid; ++i)
+      {
+        char def = line[i];
+        int value = char_to_value (def);
+
+        if (value >= 0)
+          record_set_value (record, i, value + 1);
+        else if (def != ' ' && def != '.' && def != '0')
+          valid = false;
+      }
+
+      /* Poison malformed lines so the loader reports them; anything after
+         a separating space (e.g. generator grades) is ignored */
+      if (! valid ||
+          (line[BOARD_ELEMS] != '\0' &&
+           line[BOARD_ELEMS] != '\n' &&
+           line[BOARD_ELEMS] != ' '))
+        memset (record, 0xFF, CORPUS_RECORD_SIZE);
+
+      ++record_count;
+    }
+
+    records = packed;
+  }
+
+  if (records != NULL)
+  {
+    struct timespec start_time;
+    clock_gettime (CLOCK_MONOTONIC, &start_time);
+
+    if (jobs > 1)
+      solve_batch_parallel (records, record_count, &blank, jobs, count);
+#if defined (__SSE2__) && BOARD_DIM == 9
+    else if (! count)
+      solve_batch_wide (records, record_count, &blank, root_board, &journal);
+#endif
+    else
+      for (unsigned long long i = 0; i < record_count; ++i)
+      {
+        board_copy (&blank, root_board);
+
+        if (! copy_packed_to_board (records + (i * CORPUS_RECORD_SIZE),
+                                    root_board))
+        {
+          fprintf (stderr, "Bad board %llu\n", i + 1);
+          if (count)
+            puts ("0");
+          else
+            print_board_line (root_board);
+          continue;
+        }
+
+        if (count)
+          count_batch_board (root_board, &journal);
+        else
+          solve_batch_board (root_board, &journal, i + 1);
+      }
+
+    struct timespec end_time;
+    clock_gettime (CLOCK_MONOTONIC, &end_time);
+
+    if (jobs > 1)
+      solve_stats.solve_time =
+        (end_time.tv_sec - start_time.tv_sec) +
+        ((end_time.tv_nsec - start_time.tv_nsec) / 1000000000.0L);
+  }
+
+  if (region != NULL)
+    munmap (region, region_size);
+  free (packed);
+
+  fclose (batch);
+  journal_free (&journal);
+  tables_free (&boards);
+
+  /* Statistics go to stderr so they never mix with solution lines */
+  if (stats)
+    stats_print (stderr);
+
+  return result;
+}
+
+
+/**
+ * Convert a text batch file to the packed binary corpus format on stdout
+ */
+static int
+pack_batch (const char *path)
+{
+  FILE *batch = fopen (path, "r");
+  if (batch == NULL)
+  {
+    fprintf (stderr, "Could not open batch file: %s\n", path);
+    return 1;
+  }
+
+  fwrite (CORPUS_MAGIC, 1, CORPUS_MAGIC_LENGTH, stdout);
+
+  char line[CORPUS_LINE_CAPACITY];
+  unsigned long long line_number = 0;
+
+  while (fgets (line, sizeof line, batch) != NULL)
+  {
+    ++line_number;
+
+    if (line[0] == '\n')
+      continue;
+
+    unsigned char record[CORPUS_RECORD_SIZE];
+    memset (record, 0, sizeof record);
+
+    bool valid = true;
+    for (unsigned i = 0; i < BOARD_ELEMS && valid; ++i)
+    {
+      char def = line[i];
+      int value = char_to_value (def);
+
+      if (value >= 0)
+        record_set_value (record, i, value + 1);
+      else if (def != ' ' && def != '.' && def != '0')
+        valid = false;
+    }
+
+    if (! valid ||
+        (line[BOARD_ELEMS] != '\0' &&
+         line[BOARD_ELEMS] != '\n' &&
+         line[BOARD_ELEMS] != ' '))
+    {
+      fprintf (stderr, "Bad board on line %llu\n", line_number);
+      continue;
+    }
+
+    fwrite (record, 1, sizeof record, stdout);
+  }
+
+  fclose (batch);
+
+  return 0;
+}
+
+
+/**
+ * Frame composition buffer: board views are rendered, ANSI escapes
+ * included, into this preallocated buffer and flushed to stdout with a
+ * single write, instead of going through stdio one cell at a time
+ *
+ * The buffer is shared by the main and render threads, which never draw
+ * concurrently: the render thread owns all drawing between render_start
+ * and render_stop
+ *
+ * The verbose view is the largest frame: every element drawn as a grid of
+ * positioned potential digits, each at most a cursor escape plus a
+ * coloured digit; wider boards need a correspondingly larger buffer
+ */
+#if BOARD_DIM == 9
+#define FRAME_CAPACITY (1 << 16)
+#else
+#define FRAME_CAPACITY (1 << 20)
+#endif
+
+static char frame_data[FRAME_CAPACITY];
+static unsigned frame_length = 0;
+
+
+/**
+ * Append raw bytes to the frame, dropping anything past capacity
+ */
+static void
+frame_append (const char *text, unsigned length)
+{
+  if (frame_length + length > FRAME_CAPACITY)
+    length = FRAME_CAPACITY - frame_length;
+
+  memcpy (frame_data + frame_length, text, length);
+  frame_length += length;
+}
+
+
+/**
+ * Append a NUL-terminated string to the frame
+ */
+static void
+frame_append_str (const char *text)
+{
+  frame_append (text, strlen (text));
+}
+
+
+/**
+ * Append a cursor-positioning escape to the frame
+ */
+static void
+frame_set_cursor (unsigned y, unsigned x)
+{
+  char escape[16];
+
+  frame_append (
+      escape,
+      (unsigned) snprintf (escape, sizeof escape, "\033[%u;%uH", x + 1, y + 1)
+  );
+}
+
+
+/**
+ * Write the composed frame to stdout in one go and reset it
+ *
+ * Pending stdio output is flushed first so frames never overtake text
+ * emitted through printf
+ */
+static void
+frame_flush (void)
+{
+  fflush (stdout);
+
+  unsigned written = 0;
+  while (written < frame_length)
+  {
+    ssize_t chunk = write (
+        STDOUT_FILENO,
+        frame_data + written,
+        frame_length - written
+    );
+
+    if (chunk <= 0)
+      break;
+
+    written += chunk;
+  }
+
+  frame_length = 0;
+}
+
+
+static void
+ansi_set_cursor (unsigned y, unsigned x)
+{
+  frame_set_cursor (y, x);
+  frame_flush ();
+}
+
+
+static void
+ansi_clear_screen ()
+{
+  frame_append_str (CLEAR "\n");
+  frame_flush ();
+}
+
+
+void
+ansi_cursor_show (bool show)
+{
+  frame_append_str (show ? "\e[?25h" : "\e[?25l");
+  frame_flush ();
+}
+
+static void
+print_board_verbose (
+  const struct board *board,
+  unsigned whence_x,
+  unsigned whence_y
+)
+{
+  for (board_pos y = 0; y < BOARD_DIM; ++y)
+  {
+    for (board_pos x = 0; x < BOARD_DIM; ++x)
+    {
+      for (element_value vy = 0; vy < BOARD_SUB; ++vy)
+        for (element_value vx = 0; vx < BOARD_SUB; ++vx)
+        {
+          element_value check = vx + (vy * BOARD_SUB);
+          char digit;
+
+          frame_set_cursor (
+              whence_x + (x * (BOARD_SUB + 1)) + vx,
+              whence_y + (y * (BOARD_SUB + 1)) + vy
+          );
+
+          if (board_has_value (board, x, y))
+          {
+            digit = value_to_char (board_get_value (board, x, y));
+            frame_append (&digit, 1);
+          }
+          else if (board_is_marked (board, x, y, check))
+          {
+            digit = value_to_char (check);
+            frame_append_str (COLOUR_RED);
+            frame_append (&digit, 1);
+            frame_append_str (COLOUR_RESET);
+          }
+          else
+            frame_append (" ", 1);
+
+          if (vx == BOARD_SUB - 1 && x != BOARD_DIM - 1)
+            frame_append ("|", 1);
+        }
+    }
+
+    frame_set_cursor (0, (y * (BOARD_SUB + 1)) + BOARD_SUB);
+    if (y != BOARD_DIM - 1)
+    {
+      for (unsigned i = 0; i < ((BOARD_SUB + 1) * BOARD_DIM) - 1; ++i)
+        if ((i + 1) % (BOARD_SUB + 1) == 0)
+          frame_append ("+", 1);
+        else
+          frame_append ("-", 1);
+    }
+  }
+
+  frame_flush ();
+}
+
+
+static void
+print_board (const struct board *board, const struct board *compare, unsigned whence_x, unsigned whence_y)
+{
+  for (board_pos y = 0; y < BOARD_DIM; ++y)
+  {
+    /* Print row */
+    for (board_pos x = 0; x < BOARD_DIM; ++x)
+    {
+      char digit;
+
+      frame_set_cursor (whence_x + (x * 2), whence_y + (y * 2));
+
+      /* Print board element */
+      if (board_has_value (board, x, y))
+      {
+        digit = value_to_char (board_get_value (board, x, y));
+
+        if (compare != NULL && ! board_has_value (compare, x, y))
+        {
+          frame_append_str (COLOUR_RED);
+          frame_append (&digit, 1);
+          frame_append_str (COLOUR_RESET);
+        }
+        else
+          frame_append (&digit, 1);
+      }
+      else
+        frame_append (" ", 1);
+
+      /* Print column element delimiter */
+      if (x < BOARD_DIM - 1)
+        frame_append ("|", 1);
+    }
+
+    /* Print row element delimiter */
+    if (y < BOARD_DIM - 1)
+    {
+      for (board_pos x = 0; x < (2 * BOARD_DIM) - 1; ++x)
+      {
+        frame_set_cursor (whence_x + x, whence_y + (y * 2 + 1));
+        if ((x & 1) == 0)
+          frame_append ("-", 1);
+        else
+          frame_append ("+", 1);
+      }
+    }
+  }
+
+  frame_flush ();
+}
+
+
+/**
+ * Render frame rate of the verbose-mode render thread
+ */
+#define RENDER_FPS 30
+
+
+/**
+ * Double-buffered board snapshots shared between the solve thread and the
+ * render thread
+ *
+ * The writer alternates buffers and brackets each copy with an odd/even
+ * sequence store, so the reader can detect and discard a torn frame without
+ * ever blocking the solver
+ */
+struct render_state {
+  struct board boards[2];
+  unsigned long long counters[2];
+  atomic_uint seq[2];
+  atomic_uint published;              /* Index of the newest stable buffer */
+  atomic_bool active;
+};
+
+static struct render_state render_state;
+
+
+/**
+ * Publish a snapshot of the board for the render thread; the solver's only
+ * cost is this buffer copy
+ */
+static void
+render_publish (const struct board *board, unsigned long long counter)
+{
+  unsigned idx =
+    1 - atomic_load_explicit (&render_state.published, memory_order_relaxed);
+
+  unsigned seq =
+    atomic_load_explicit (&render_state.seq[idx], memory_order_relaxed);
+
+  atomic_store_explicit (
+      &render_state.seq[idx], seq + 1, memory_order_release
+  );
+  board_copy (board, &render_state.boards[idx]);
+  render_state.counters[idx] = counter;
+  atomic_store_explicit (
+      &render_state.seq[idx], seq + 2, memory_order_release
+  );
+
+  atomic_store_explicit (&render_state.published, idx, memory_order_release);
+}
+
+
+/**
+ * Render thread: draw the newest stable snapshot at a fixed frame rate
+ */
+static void *
+render_worker (void *arg)
+{
+  (void) arg;
+
+  struct board frame;
+  unsigned long long counter;
+
+  const struct timespec tick = { 0, 1000000000L / RENDER_FPS };
+
+  while (atomic_load_explicit (&render_state.active, memory_order_relaxed))
+  {
+    nanosleep (&tick, NULL);
+
+    /* Grab the newest snapshot, discarding torn reads */
+    for (;;)
+    {
+      unsigned idx =
+        atomic_load_explicit (&render_state.published, memory_order_acquire);
+      unsigned before =
+        atomic_load_explicit (&render_state.seq[idx], memory_order_acquire);
+
+      if (before & 1)
+        continue;
+
+      board_copy (&render_state.boards[idx], &frame);
+      counter = render_state.counters[idx];
+
+      atomic_thread_fence (memory_order_acquire);
+
+      if (
+          atomic_load_explicit (
+              &render_state.seq[idx], memory_order_relaxed
+          ) == before
+      )
+        break;
+    }
+
+    print_board_verbose (&frame, 0, 0);
+    ansi_set_cursor (0, (BOARD_DIM * (BOARD_SUB + 1)) - 1);
+    printf ("Iteration: %llu", counter);
+    fflush (stdout);
+  }
+
+  return NULL;
+}
+
+
+/**
+ * Start the render thread with the given board as the first frame
+ */
+static void
+render_start (pthread_t *thread, const struct board *board)
+{
+  atomic_store (&render_state.active, true);
+  render_publish (board, 0);
+  pthread_create (thread, NULL, render_worker, NULL);
+}
+
+
+/**
+ * Stop and join the render thread
+ */
+static void
+render_stop (pthread_t thread)
+{
+  atomic_store (&render_state.active, false);
+  pthread_join (thread, NULL);
+}
+
+
+/**
+ * Compute first potential value of a given potential mask
+ */
+element_value
+first_potential_value (board_mask potential, bool *error)
+{
+  if (potential == 0)
+  {
+    *error = true;
+    return 0;
+  }
+
+  *error = false;
+
+  return bits_first (potential);
+}
+
+
+/**
+ * Run the deterministic constraint passes (naked singles, hidden singles,
+ * naked subsets) until none makes progress
+ *
+ * Returns false if the board is proven dead; placements and eliminations
+ * are journalled and rewind with the enclosing checkpoint
+ */
+static bool
+propagate (
+  struct board *board,
+  struct board_journal *journal
+)
+{
+  bool error;
+  bool progress = true;
+
+  while (progress)
+  {
+    progress = false;
+
+    /* Reduce using low-complexity computation */
+    while (board->complexity == 1)
+    {
+      for (unsigned word = 0; word < BOARD_HAS_WORDS; ++word)
+      {
+        unsigned long long empty = board_empty_mask (board, word);
+
+        while (empty != 0)
+        {
+          unsigned pos = (word * 64) + bits_first64 (empty);
+          empty &= empty - 1;
+
+          if (board_elem_complexity (board, pos) == 1)
+          {
+            element_value value =
+              first_potential_value (board->potential[pos], &error);
+            if (error) return false;
+
+            ++solve_stats.singles;
+
+            if (! board_place_trial (
+                    board, journal, pos % BOARD_DIM, pos / BOARD_DIM, value
+            ))
+              return false;
+          }
+        }
+      }
+
+      if (! board_refresh_complexity (board))
+        return false;
+    }
+
+    /* Place values that have a single candidate element in some region */
+    if (board->complexity > 1)
+    {
+      int placed = board_place_hidden_singles (board, journal);
+
+      if (placed < 0)
+        return false;
+
+      if (placed > 0)
+      {
+        if (! board_refresh_complexity (board))
+          return false;
+
+        progress = true;
+      }
+    }
+
+    /* Eliminate candidates confined to naked pair/triple subsets, but only
+       once the cheaper singles passes have stalled */
+    if (! progress && board->complexity > 1)
+    {
+      int eliminated = board_eliminate_subsets (board, journal);
+
+      if (eliminated < 0)
+        return false;
+
+      if (eliminated > 0)
+      {
+        if (! board_refresh_complexity (board))
+          return false;
+
+        progress = true;
+      }
+    }
+  }
+
+  return true;
+}
+
+
+/**
+ * Speculation value orderings selectable with -oN
+ */
+enum value_order_mode {
+  VALUE_ORDER_ASCENDING = 0,          /* Try candidate values low to high */
+  VALUE_ORDER_LEAST_CONSTRAINING      /* Fewest adjacent candidates first */
+};
+
+static unsigned value_order = VALUE_ORDER_ASCENDING;
+
+
+/**
+ * One speculation level of the iterative search: the element being guessed
+ * on, the values not yet tried (as a mask cursor or an ordered list), the
+ * value currently placed and the journal checkpoint that precedes its
+ * placement
+ */
+struct search_frame {
+  unsigned pos;
+  board_mask mask;
+  element_value value;
+  unsigned mark;
+  element_value order[BOARD_DIM];     /* Candidates in speculation order */
+  unsigned char cursor;
+  unsigned char count;
+};
+
+
+/**
+ * Prepare a frame's untried candidate values for its element
+ *
+ * The least-constraining ordering scores each candidate by how many
+ * valueless adjacent elements still hold its bit in their potential, and
+ * tries low-impact values first; the masks are already in hand, so the
+ * score is one load per adjacent element at most
+ */
+static void
+frame_order_values (const struct board *board, struct search_frame *frame)
+{
+  frame->mask = board->potential[frame->pos];
+
+  if (value_order == VALUE_ORDER_ASCENDING)
+    return;
+
+  unsigned scores[BOARD_DIM];
+  element_value value;
+
+  frame->cursor = 0;
+  frame->count = 0;
+
+  BITS_FOREACH (value, frame->mask)
+  {
+    unsigned score = 0;
+
+    for (unsigned i = 0; i < BOARD_LINK_COUNT; ++i)
+    {
+      board_pos adjacent = board_links[frame->pos][i];
+
+      if (! board_elem_has_value (board, adjacent) &&
+          ((board->potential[adjacent] >> value) & 1))
+        ++score;
+    }
+
+    /* Insertion sort; one entry per candidate value and stable, so equal
+       scores keep the ascending value order */
+    unsigned at = frame->count++;
+    while (at > 0 && scores[at - 1] > score)
+    {
+      scores[at] = scores[at - 1];
+      frame->order[at] = frame->order[at - 1];
+      --at;
+    }
+    scores[at] = score;
+    frame->order[at] = value;
+  }
+}
+
+
+/**
+ * Pop the next value to try from a frame, in the active speculation order
+ *
+ * Returns false once the frame has no untried values left
+ */
+static bool
+frame_next_value (struct search_frame *frame, element_value *value)
+{
+  if (value_order == VALUE_ORDER_ASCENDING)
+  {
+    if (frame->mask == 0)
+      return false;
+
+    *value = bits_first (frame->mask);
+    frame->mask &= frame->mask - 1;
+
+    return true;
+  }
+
+  if (frame->cursor == frame->count)
+    return false;
+
+  *value = frame->order[frame->cursor++];
+
+  return true;
+}
+
+
+/**
+ * Search checkpoint file format: a header carrying the stack depth and
+ * journal length, followed by the raw board, the live speculation frames
+ * and the journal entries. The struct sizes are recorded and verified on
+ * load, so a checkpoint from a different build is rejected rather than
+ * misread; checkpoints are host-local state, not an interchange format
+ */
+#define CHECKPOINT_MAGIC "SDKCHK\r\n"
+
+/**
+ * Nodes between periodic checkpoints; a power of two so the due check is
+ * one mask of the node counter. Overridable at compile time
+ */
+#ifndef CHECKPOINT_INTERVAL
+#define CHECKPOINT_INTERVAL (1ULL << 20)
+#endif
+
+struct checkpoint_header {
+  char magic[8];
+  unsigned depth;
+  unsigned journal_length;
+  unsigned board_size;
+  unsigned frame_size;
+  unsigned entry_size;
+};
+
+
+/**
+ * Checkpoint file for the running search, set by -C; NULL disables all
+ * checkpointing
+ */
+static const char *checkpoint_path = NULL;
+
+/**
+ * Raised by SIGINT/SIGTERM when checkpointing is enabled: the search saves
+ * its state at the next node and unwinds
+ */
+static volatile sig_atomic_t solve_interrupt = 0;
+
+/**
+ * Whether the search unwound via an interrupt checkpoint rather than an
+ * exhausted tree, so an unsolved exit is not reported as unsolvable
+ */
+static bool solve_interrupted = false;
+
+
+static void
+checkpoint_signal (int signum)
+{
+  (void) signum;
+  solve_interrupt = 1;
+}
+
+
+/**
+ * Atomically replace the checkpoint file with the current search state
+ */
+static void
+checkpoint_save (
+  const char *path,
+  const struct board *board,
+  const struct board_journal *journal,
+  const struct search_frame *frames,
+  unsigned depth
+)
+{
+  char tmp_path[4096];
+
+  if ((unsigned) snprintf (tmp_path, sizeof tmp_path, "%s.tmp", path) >=
+      sizeof tmp_path)
+    return;
+
+  FILE *file = fopen (tmp_path, "wb");
+  if (file == NULL)
+    return;
+
+  struct checkpoint_header header;
+  memcpy (header.magic, CHECKPOINT_MAGIC, sizeof header.magic);
+  header.depth = depth;
+  header.journal_length = journal->length;
+  header.board_size = sizeof *board;
+  header.frame_size = sizeof *frames;
+  header.entry_size = sizeof *journal->entries;
+
+  bool written =
+    fwrite (&header, sizeof header, 1, file) == 1 &&
+    fwrite (board, sizeof *board, 1, file) == 1 &&
+    (depth == 0 || fwrite (frames, sizeof *frames, depth, file) == depth) &&
+    (journal->length == 0 ||
+     fwrite (
+         journal->entries,
+         sizeof *journal->entries,
+         journal->length,
+         file
+     ) == journal->length);
+
+  if (fclose (file) != 0 || ! written || rename (tmp_path, path) != 0)
+    unlink (tmp_path);
+}
+
+
+/**
+ * Restore a search state saved by `checkpoint_save`
+ *
+ * Returns false, leaving board and journal untouched, if no readable and
+ * structurally matching checkpoint exists at the path
+ */
+static bool
+checkpoint_load (
+  const char *path,
+  struct board *board,
+  struct board_journal *journal,
+  struct search_frame *frames,
+  unsigned *depth
+)
+{
+  FILE *file = fopen (path, "rb");
+  if (file == NULL)
+    return false;
+
+  struct checkpoint_header header;
+  struct board loaded;
+
+  bool valid =
+    fread (&header, sizeof header, 1, file) == 1 &&
+    memcmp (header.magic, CHECKPOINT_MAGIC, sizeof header.magic) == 0 &&
+    header.depth < MAX_DEPTH &&
+    header.board_size == sizeof *board &&
+    header.frame_size == sizeof *frames &&
+    header.entry_size == sizeof *journal->entries &&
+    fread (&loaded, sizeof loaded, 1, file) == 1 &&
+    (header.depth == 0 ||
+     fread (frames, sizeof *frames, header.depth, file) == header.depth);
+
+  if (valid && header.journal_length > 0)
+  {
+    if (journal->capacity < header.journal_length)
+    {
+      journal->capacity = header.journal_length;
+      journal->entries = realloc (
+          journal->entries,
+          journal->capacity * sizeof *journal->entries
+      );
+    }
+
+    valid = fread (
+        journal->entries,
+        sizeof *journal->entries,
+        header.journal_length,
+        file
+    ) == header.journal_length;
+  }
+
+  fclose (file);
+
+  if (! valid)
+  {
+    fprintf (stderr, "Ignoring unusable checkpoint: %s\n", path);
+    journal_clear (journal);
+    return false;
+  }
+
+  board_copy (&loaded, board);
+  journal->length = header.journal_length;
+  *depth = header.depth;
+
+  return true;
+}
+
+
+/**
+ * Solve the board with an explicit-stack depth-first search
+ *
+ * Each iteration propagates constraints, then either reports the solution,
+ * pushes a speculation frame for a simplest element, or backtracks by
+ * rewinding the journal and advancing the deepest frame to its next value.
+ * Speculative placements are applied in place and rolled back through the
+ * journal when a branch fails; on success the solution is left on the board
+ *
+ * With -C the search resumes from a saved checkpoint when one exists, saves
+ * one periodically, and saves on SIGINT/SIGTERM before unwinding, so a
+ * preempted long-running solve never discards completed search work
+ */
+#ifdef NOVERB
+bool
+simplify (
+  struct board *board,
+  struct board_journal *journal
+)
+#else
+bool
+simplify (
+  struct board *board,
+  struct board_journal *journal,
+  unsigned long long *counter,
+  unsigned verbosity
+)
+#endif
+{
+  struct search_frame frames[MAX_DEPTH];
+  unsigned long long node_hash[MAX_DEPTH];
+  unsigned depth = 0;
+
+  /* The budget is charged from a local counter: the global node total is
+     shared with every other worker under -j and would bill this search for
+     their work */
+  solve_over_budget = false;
+  unsigned long long nodes = 0;
+
+  if (checkpoint_path != NULL &&
+      checkpoint_load (checkpoint_path, board, journal, frames, &depth))
+  {
+    solve_stats.depth += depth;
+    if (solve_stats.depth > solve_stats.max_depth)
+      solve_stats.max_depth = solve_stats.depth;
+  }
+
+  for (;;)
+  {
+    /* Another worker already won the race for a solution */
+    if (atomic_load_explicit (&solve_cancelled, memory_order_relaxed))
+    {
+      solve_stats.depth -= depth;
+      return false;
+    }
+
+    ++solve_stats.nodes;
+
+    if (effort_budget != 0 && ++nodes > effort_budget)
+    {
+      /* Unwind the speculation so the caller's board holds only givens
+         and verified deductions, as the exhausted-search path leaves it */
+      if (depth > 0)
+        journal_rewind (journal, board, frames[0].mark);
+
+      solve_over_budget = true;
+      solve_stats.depth -= depth;
+      return false;
+    }
+
+    if (checkpoint_path != NULL)
+    {
+      if (solve_interrupt)
+      {
+        checkpoint_save (checkpoint_path, board, journal, frames, depth);
+        solve_interrupted = true;
+        solve_stats.depth -= depth;
+        return false;
+      }
+
+      if ((solve_stats.nodes & (CHECKPOINT_INTERVAL - 1)) == 0)
+        checkpoint_save (checkpoint_path, board, journal, frames, depth);
+    }
+
+#ifndef NOVERB
+    if (verbosity > 0)
+    {
+      if (((*counter) & (0xFFFF >> (4 * (4 - verbosity)))) == 0)
+        render_publish (board, *counter);
+      *counter += 1;
+    }
+#endif
+
+    if (trans_table != NULL)
+    {
+      node_hash[depth] = board_hash (board);
+
+      /* A state already proven dead need not be searched again */
+      if (trans_table[node_hash[depth] & TRANS_MASK] == node_hash[depth])
+      {
+        ++solve_stats.tt_hits;
+        goto backtrack;
+      }
+    }
+
+    if (propagate (board, journal))
+    {
+      if (board->complexity == 0)
+      {
+        /* Found solution; leave it in place */
+        solve_stats.depth -= depth;
+        return true;
+      }
+
+      /* Push a frame for a simplest element on the board */
+      for (unsigned word = 0; word < BOARD_HAS_WORDS; ++word)
+      {
+        unsigned long long empty = board_empty_mask (board, word);
+
+        while (empty != 0)
+        {
+          unsigned pos = (word * 64) + bits_first64 (empty);
+          empty &= empty - 1;
+
+          if (board_elem_complexity (board, pos) == board->complexity)
+          {
+            frames[depth].pos = pos;
+            frame_order_values (board, &frames[depth]);
+
+            goto advance;
+          }
+        }
+      }
+    }
+
+  backtrack:
+    /* The node is dead: remember its entry state as unsolvable, discard its
+       frame, undo the placement that created it and resume the parent frame
+       at its next value */
+    if (trans_table != NULL)
+      trans_table[node_hash[depth] & TRANS_MASK] = node_hash[depth];
+
+    if (depth == 0)
+      return false;
+
+    --depth;
+    --solve_stats.depth;
+
+    journal_rewind (journal, board, frames[depth].mark);
+
+    if (! board_unmark_trial (
+            board,
+            journal,
+            frames[depth].pos % BOARD_DIM,
+            frames[depth].pos / BOARD_DIM,
+            frames[depth].value
+    ))
+      goto backtrack;
+
+  advance:
+    /* Try the deepest frame's next untried value */
+    for (;;)
+    {
+      struct search_frame *frame = &frames[depth];
+
+      if (! frame_next_value (frame, &frame->value))
+        goto backtrack;
+
+      frame->mark = journal_checkpoint (journal, board);
+
+      ++solve_stats.guesses;
+
+      if (board_place_trial (
+              board,
+              journal,
+              frame->pos % BOARD_DIM,
+              frame->pos / BOARD_DIM,
+              frame->value
+      ))
+      {
+        board_refresh_complexity (board);
+
+        ++depth;
+
+        ++solve_stats.depth;
+        if (solve_stats.depth > solve_stats.max_depth)
+          solve_stats.max_depth = solve_stats.depth;
+
+        break;
+      }
+
+      /* Placement rejected outright: roll back and prune the value */
+      journal_rewind (journal, board, frame->mark);
+
+      if (! board_unmark_trial (
+              board,
+              journal,
+              frame->pos % BOARD_DIM,
+              frame->pos / BOARD_DIM,
+              frame->value
+      ))
+        goto backtrack;
+    }
+  }
+}
+
+
+/**
+ * Count the solutions of the board with the same propagation and
+ * speculation machinery as `simplify`, early-exiting once `cap` solutions
+ * have been found; a cap of 2 is the usual uniqueness check
+ *
+ * Subtrees are only recorded in the transposition table when they produced
+ * no solution, so -t remains sound while counting. The board is left in an
+ * unspecified partially-rewound state; callers wanting the solved grid
+ * should use `simplify`
+ *
+ * The effort budget applies here too: a counting search that exceeds it
+ * returns the solutions found so far with `solve_over_budget` set, so
+ * callers can report the count as cut short rather than exact
+ */
+static unsigned long long
+count_solutions (
+  struct board *board,
+  struct board_journal *journal,
+  unsigned long long cap
+)
+{
+  struct search_frame frames[MAX_DEPTH];
+  unsigned long long node_hash[MAX_DEPTH];
+  unsigned long long node_count[MAX_DEPTH];
+  unsigned long long solutions = 0;
+  unsigned depth = 0;
+
+  solve_over_budget = false;
+  unsigned long long nodes = 0;
+
+  for (;;)
+  {
+    ++solve_stats.nodes;
+
+    if (effort_budget != 0 && ++nodes > effort_budget)
+    {
+      solve_over_budget = true;
+      solve_stats.depth -= depth;
+      return solutions;
+    }
+
+    if (trans_table != NULL)
+    {
+      node_hash[depth] = board_hash (board);
+      node_count[depth] = solutions;
+
+      if (trans_table[node_hash[depth] & TRANS_MASK] == node_hash[depth])
+      {
+        ++solve_stats.tt_hits;
+        goto backtrack;
+      }
+    }
+
+    if (propagate (board, journal))
+    {
+      if (board->complexity == 0)
+      {
+        /* Found a solution; keep searching for more unless capped */
+        if (++solutions >= cap)
+        {
+          solve_stats.depth -= depth;
+          return solutions;
+        }
+
+        goto backtrack;
+      }
+
+      /* Push a frame for a simplest element on the board */
+      for (unsigned word = 0; word < BOARD_HAS_WORDS; ++word)
+      {
+        unsigned long long empty = board_empty_mask (board, word);
+
+        while (empty != 0)
+        {
+          unsigned pos = (word * 64) + bits_first64 (empty);
+          empty &= empty - 1;
+
+          if (board_elem_complexity (board, pos) == board->complexity)
+          {
+            frames[depth].pos = pos;
+            frame_order_values (board, &frames[depth]);
+
+            goto advance;
+          }
+        }
+      }
+    }
+
+  backtrack:
+    /* Record the node as dead only if no solution lies beneath it */
+    if (trans_table != NULL && node_count[depth] == solutions)
+      trans_table[node_hash[depth] & TRANS_MASK] = node_hash[depth];
+
+    if (depth == 0)
+      return solutions;
+
+    --depth;
+    --solve_stats.depth;
+
+    journal_rewind (journal, board, frames[depth].mark);
+
+    if (! board_unmark_trial (
+            board,
+            journal,
+            frames[depth].pos % BOARD_DIM,
+            frames[depth].pos / BOARD_DIM,
+            frames[depth].value
+    ))
+      goto backtrack;
+
+  advance:
+    /* Try the deepest frame's next untried value */
+    for (;;)
+    {
+      struct search_frame *frame = &frames[depth];
+
+      if (! frame_next_value (frame, &frame->value))
+        goto backtrack;
+
+      frame->mark = journal_checkpoint (journal, board);
+
+      ++solve_stats.guesses;
+
+      if (board_place_trial (
+              board,
+              journal,
+              frame->pos % BOARD_DIM,
+              frame->pos / BOARD_DIM,
+              frame->value
+      ))
+      {
+        board_refresh_complexity (board);
+
+        ++depth;
+
+        ++solve_stats.depth;
+        if (solve_stats.depth > solve_stats.max_depth)
+          solve_stats.max_depth = solve_stats.depth;
+
+        break;
+      }
+
+      /* Placement rejected outright: roll back and prune the value */
+      journal_rewind (journal, board, frame->mark);
+
+      if (! board_unmark_trial (
+              board,
+              journal,
+              frame->pos % BOARD_DIM,
+              frame->pos / BOARD_DIM,
+              frame->value
+      ))
+        goto backtrack;
+    }
+  }
+}
+
+
+/**
+ * Queue of speculation branches awaiting a worker
+ *
+ * Entries before `next` have been handed out; workers pull the rest under
+ * the queue lock, which approximates stealing at the granularity of whole
+ * top-level branches
+ */
+struct branch_queue {
+  struct board *boards;
+  unsigned count;
+  unsigned capacity;
+  unsigned next;
+  pthread_mutex_t lock;
+};
+
+
+/**
+ * Shared state of one parallel solve
+ */
+struct solve_shared {
+  struct branch_queue queue;
+  struct board *solution;             /* Target for the winning branch */
+  bool solved;
+  bool over_budget;                   /* Some branch hit the effort budget */
+  pthread_mutex_t solution_lock;
+};
+
+
+/**
+ * Append a branch slot to a queue and return it for population
+ */
+static struct board *
+queue_append (struct branch_queue *queue)
+{
+  if (queue->count == queue->capacity)
+  {
+    queue->capacity *= 2;
+    queue->boards = realloc (
+        queue->boards,
+        sizeof (struct board) * queue->capacity
+    );
+  }
+
+  return &queue->boards[queue->count++];
+}
+
+
+/**
+ * Split the search space into at least `target` independent branches by
+ * repeatedly expanding the lowest-depth boards at their most constrained
+ * element
+ *
+ * Returns true if a solution was found outright during expansion, in which
+ * case it has been copied to `solution`
+ */
+static bool
+queue_expand (
+  struct branch_queue *queue,
+  struct board *solution,
+  unsigned target
+)
+{
+  while (
+    queue->next < queue->count &&
+    (queue->count - queue->next) < target
+  )
+  {
+    /* Pop the oldest (lowest-depth) branch; copy out since appending the
+       children may reallocate the queue */
+    struct board parent;
+    board_copy (&queue->boards[queue->next++], &parent);
+
+    if (parent.complexity == 0)
+    {
+      board_copy (&parent, solution);
+      return true;
+    }
+
+    /* Find a most constrained element to branch on */
+    bool branched = false;
+
+    for (unsigned word = 0; word < BOARD_HAS_WORDS && ! branched; ++word)
+    {
+      unsigned long long empty = board_empty_mask (&parent, word);
+
+      while (empty != 0 && ! branched)
+      {
+        unsigned pos = (word * 64) + bits_first64 (empty);
+        empty &= empty - 1;
+
+        if (board_elem_complexity (&parent, pos) == parent.complexity)
+        {
+          element_value value;
+
+          BITS_FOREACH (value, parent.potential[pos])
+          {
+            struct board *child = queue_append (queue);
+            board_copy (&parent, child);
+
+            /* Drop branches that die on placement */
+            if (
+                board_place (
+                    child, pos % BOARD_DIM, pos / BOARD_DIM, value
+                ) &&
+                board_refresh_complexity (child)
+            )
+            {
+              if (child->complexity == 0)
+              {
+                board_copy (child, solution);
+                return true;
+              }
+            }
+            else
+              --(queue->count);
+          }
+
+          branched = true;
+        }
+      }
+    }
+  }
+
+  return false;
+}
+
+
+/**
+ * Worker loop: pull branches off the shared queue and solve them to
+ * exhaustion until the queue drains or another worker finds a solution
+ */
+static void *
+solve_worker (void *arg)
+{
+  struct solve_shared *shared = arg;
+  struct board_journal journal;
+  unsigned long long counter = 0;
+
+  journal_init (&journal);
+
+  for (;;)
+  {
+    if (atomic_load_explicit (&solve_cancelled, memory_order_relaxed))
+      break;
+
+    /* Pull the next unclaimed branch */
+    pthread_mutex_lock (&shared->queue.lock);
+    unsigned index = shared->queue.next;
+    if (index < shared->queue.count)
+      ++(shared->queue.next);
+    pthread_mutex_unlock (&shared->queue.lock);
+
+    if (index >= shared->queue.count)
+      break;
+
+    struct board *board = &shared->queue.boards[index];
+
+    journal_clear (&journal);
+
+    bool solved =
+      simplify (board, &journal, &counter, 0) && board->complexity == 0;
+
+    /* A branch cut short by the budget taints any "no solution" verdict */
+    if (solve_over_budget)
     {
-      if (result.verbosity != 0)
+      pthread_mutex_lock (&shared->solution_lock);
+      shared->over_budget = true;
+      pthread_mutex_unlock (&shared->solution_lock);
+    }
+
+    if (solved)
+    {
+      /* First solution wins; everyone else backs off */
+      pthread_mutex_lock (&shared->solution_lock);
+      if (! shared->solved)
       {
-        result.valid = false;
-        return result;
+        shared->solved = true;
+        board_copy (board, shared->solution);
       }
-      if (strcmp (argv[i], "-v") == 0)
+      pthread_mutex_unlock (&shared->solution_lock);
+
+      atomic_store (&solve_cancelled, true);
+      break;
+    }
+  }
+
+  journal_free (&journal);
+
+  return NULL;
+}
+
+
+/**
+ * Solve a board by distributing its top-level speculation branches across
+ * `jobs` worker threads, first solution wins
+ *
+ * On success the solution is left on `board`
+ */
+static bool
+simplify_parallel (struct board *board, unsigned jobs)
+{
+  struct solve_shared shared;
+
+  shared.queue.capacity = jobs * BRANCHES_PER_WORKER * 2;
+  shared.queue.boards = malloc (
+      sizeof (struct board) * shared.queue.capacity
+  );
+  shared.queue.count = 0;
+  shared.queue.next = 0;
+  shared.solution = board;
+  shared.solved = false;
+  shared.over_budget = false;
+  pthread_mutex_init (&shared.queue.lock, NULL);
+  pthread_mutex_init (&shared.solution_lock, NULL);
+
+  board_copy (board, queue_append (&shared.queue));
+
+  bool solved =
+    queue_expand (&shared.queue, board, jobs * BRANCHES_PER_WORKER);
+
+  if (! solved && shared.queue.next < shared.queue.count)
+  {
+    atomic_store (&solve_cancelled, false);
+
+    pthread_t *workers = malloc (sizeof (pthread_t) * jobs);
+
+    for (unsigned i = 0; i < jobs; ++i)
+      pthread_create (&workers[i], NULL, solve_worker, &shared);
+
+    for (unsigned i = 0; i < jobs; ++i)
+      pthread_join (workers[i], NULL);
+
+    free (workers);
+
+    solved = shared.solved;
+  }
+
+  /* Over-budget matters only when the board went unsolved: a branch that
+     ran out of budget is irrelevant once another found a solution */
+  solve_over_budget = ! solved && shared.over_budget;
+
+  pthread_mutex_destroy (&shared.queue.lock);
+  pthread_mutex_destroy (&shared.solution_lock);
+  free (shared.queue.boards);
+
+  return solved;
+}
+
+
+/**
+ * Rebuild a board from a solved grid restricted to its remaining givens
+ */
+static void
+board_from_givens (
+  struct board *board,
+  const struct board *blank,
+  const element_value *solution,
+  const bool *given
+)
+{
+  board_copy (blank, board);
+
+  for (unsigned pos = 0; pos < BOARD_ELEMS; ++pos)
+    if (given[pos])
+      board_place (board, pos % BOARD_DIM, pos / BOARD_DIM, solution[pos]);
+
+  board_refresh_complexity (board);
+}
+
+
+/**
+ * Fill a board into a complete random grid: seed a handful of random legal
+ * placements to randomize the search, then let the solver complete the
+ * grid. Seeds that happen to kill the board are simply retried
+ */
+static void
+generate_grid (
+  struct board *board,
+  const struct board *blank,
+  struct board_journal *journal
+)
+{
+  for (;;)
+  {
+    unsigned long long counter = 0;
+    bool dead = false;
+
+    board_copy (blank, board);
+    journal_clear (journal);
+
+    for (unsigned seeds = 0; seeds < 11 && ! dead; ++seeds)
+    {
+      board_pos x = rand () % BOARD_DIM;
+      board_pos y = rand () % BOARD_DIM;
+
+      if (board_has_value (board, x, y))
+        continue;
+
+      /* Pick a uniformly random remaining candidate of the element */
+      board_mask allowed = board->potential[ELEM_POS (x, y)];
+      unsigned pick = rand () % bits_count (allowed);
+
+      element_value value;
+      BITS_FOREACH (value, allowed)
+        if (pick-- == 0)
+          break;
+
+      dead = ! board_place (board, x, y, value);
+    }
+
+    board_refresh_complexity (board);
+
+    if (! dead &&
+        simplify (board, journal, &counter, 0) &&
+        board->complexity == 0)
+      return;
+  }
+}
+
+
+/**
+ * Generate one graded puzzle: fill a random complete grid, then dig holes
+ * in random order, keeping each hole only while the uniqueness check still
+ * reports exactly one solution
+ *
+ * The emitted line is the puzzle in corpus format followed by its grade,
+ * scored from the guess and speculation-depth statistics of solving it
+ */
+static void
+generate_puzzle (
+  struct board *board,
+  const struct board *blank,
+  struct board_journal *journal
+)
+{
+  element_value solution[BOARD_ELEMS];
+  bool given[BOARD_ELEMS];
+  board_pos order[BOARD_ELEMS];
+
+  generate_grid (board, blank, journal);
+
+  for (unsigned pos = 0; pos < BOARD_ELEMS; ++pos)
+  {
+    solution[pos] = board->value[pos];
+    given[pos] = true;
+    order[pos] = pos;
+  }
+
+  /* Shuffle the digging order */
+  for (unsigned i = BOARD_ELEMS - 1; i > 0; --i)
+  {
+    unsigned j = rand () % (i + 1);
+    board_pos swap = order[i];
+
+    order[i] = order[j];
+    order[j] = swap;
+  }
+
+  for (unsigned i = 0; i < BOARD_ELEMS; ++i)
+  {
+    unsigned pos = order[i];
+
+    given[pos] = false;
+
+    board_from_givens (board, blank, solution, given);
+    journal_clear (journal);
+
+    /* A hole that breaks uniqueness goes back in */
+    if (count_solutions (board, journal, 2) != 1)
+      given[pos] = true;
+  }
+
+  /* Grade the finished puzzle by solving it once more */
+  unsigned long long counter = 0;
+  unsigned long long prior_guesses = solve_stats.guesses;
+  unsigned long long prior_max_depth = solve_stats.max_depth;
+
+  solve_stats.max_depth = 0;
+
+  board_from_givens (board, blank, solution, given);
+  journal_clear (journal);
+  simplify (board, journal, &counter, 0);
+
+  unsigned long long guesses = solve_stats.guesses - prior_guesses;
+  unsigned long long depth = solve_stats.max_depth;
+
+  if (prior_max_depth > solve_stats.max_depth)
+    solve_stats.max_depth = prior_max_depth;
+
+  char line[BOARD_LINE];
+
+  for (unsigned pos = 0; pos < BOARD_ELEMS; ++pos)
+    line[pos] = given[pos] ? value_to_char (solution[pos]) : '.';
+  line[BOARD_ELEMS] = '\0';
+
+  printf ("%s guesses=%llu depth=%llu\n", line, guesses, depth);
+}
+
+
+/**
+ * Generate a batch of graded puzzles with a unique solution each, one line
+ * per puzzle on stdout
+ */
+static int
+generate_batch (unsigned long long count, bool stats)
+{
+  struct board board;
+  struct board blank;
+  struct board_journal journal;
+
+  board_init (&blank);
+  journal_init (&journal);
+
+  srand ((unsigned) time (NULL) ^ (unsigned) getpid ());
+
+  for (unsigned long long i = 0; i < count; ++i)
+  {
+    ++solve_stats.boards;
+    generate_puzzle (&board, &blank, &journal);
+  }
+
+  journal_free (&journal);
+
+  /* Statistics go to stderr so they never mix with puzzle lines */
+  if (stats)
+    stats_print (stderr);
+
+  return 0;
+}
+
+
+/**
+ * Benchmark defaults: timed runs per board when -B carries no count, untimed
+ * warmup runs preceding them, and the corpus measured when no file is given
+ */
+#define BENCH_DEFAULT_RUNS 25
+#define BENCH_WARMUP 3
+#define BENCH_CORPUS "examples/*.txt"
+
+
+/**
+ * Seconds between two monotonic timestamps
+ */
+static double
+timespec_diff (const struct timespec *start, const struct timespec *end)
+{
+  return (end->tv_sec - start->tv_sec) +
+         ((end->tv_nsec - start->tv_nsec) / 1000000000.0);
+}
+
+
+/**
+ * Ascending comparator for qsort over run times
+ */
+static int
+bench_time_compare (const void *a, const void *b)
+{
+  double lhs = *(const double *) a;
+  double rhs = *(const double *) b;
+
+  return (lhs > rhs) - (lhs < rhs);
+}
+
+
+/**
+ * Benchmark one pre-parsed board: solve it `runs` times from in-memory
+ * copies after warmup, timing only the simplification, and emit one
+ * machine-readable result line. Returns the median run time, or 0 on a
+ * board the solver rejects
+ */
+static double
+bench_board (
+  const char *name,
+  const struct board *original,
+  struct board *root_board,
+  struct board_journal *journal,
+  double *times,
+  unsigned long long runs
+)
+{
+  unsigned long long nodes = 0;
+  unsigned long long guesses = 0;
+  bool solved = true;
+
+  for (unsigned long long run = 0; run < BENCH_WARMUP + runs; ++run)
+  {
+    unsigned long long counter = 0;
+
+    board_copy (original, root_board);
+    journal_clear (journal);
+
+    if (! (board_is_valid (root_board) &&
+           board_refresh_complexity (root_board)))
+    {
+      fprintf (stderr, "Invalid benchmark board: %s\n", name);
+      return 0;
+    }
+
+    unsigned long long nodes_before = solve_stats.nodes;
+    unsigned long long guesses_before = solve_stats.guesses;
+
+    struct timespec start_time;
+    clock_gettime (CLOCK_MONOTONIC, &start_time);
+
+    solved = simplify (root_board, journal, &counter, 0) &&
+             root_board->complexity == 0;
+
+    struct timespec end_time;
+    clock_gettime (CLOCK_MONOTONIC, &end_time);
+
+    nodes = solve_stats.nodes - nodes_before;
+    guesses = solve_stats.guesses - guesses_before;
+
+    if (run >= BENCH_WARMUP)
+      times[run - BENCH_WARMUP] = timespec_diff (&start_time, &end_time);
+  }
+
+  qsort (times, runs, sizeof (*times), bench_time_compare);
+
+  unsigned long long p99 = (runs * 99) / 100;
+  if (p99 >= runs)
+    p99 = runs - 1;
+
+  printf (
+      "bench file=%s runs=%llu median=%.9f p99=%.9f "
+      "nodes=%llu guesses=%llu solved=%u\n",
+      name,
+      runs,
+      times[runs / 2],
+      times[p99],
+      nodes,
+      guesses,
+      (unsigned) solved
+  );
+
+  return times[runs / 2];
+}
+
+
+/**
+ * Benchmark mode: load a set of boards up front, solve each repeatedly from
+ * pre-parsed in-memory copies and report per-board median/p99 solve times,
+ * per-solve node counts and an aggregate score, one key=value line per
+ * board on stdout so runs can be diffed. All rendering is bypassed and only
+ * the simplification is timed
+ *
+ * With no file argument the examples corpus next to the binary is measured
+ */
+static int
+bench_batch (const char *path, unsigned long long runs)
+{
+  struct boards_table boards;
+  tables_init (&boards);
+
+  struct board_journal journal;
+  journal_init (&journal);
+
+  struct board *root_board = boards.board_specs[0];
+  struct board original;
+
+  double *times = malloc (runs * sizeof (*times));
+
+  glob_t corpus;
+  memset (&corpus, 0, sizeof corpus);
+
+  const char *single[1] = { path };
+  const char **names = single;
+  unsigned long long name_count = 1;
+
+  if (path == NULL)
+  {
+    if (glob (BENCH_CORPUS, 0, NULL, &corpus) != 0 || corpus.gl_pathc == 0)
+    {
+      fprintf (stderr, "No benchmark boards match: %s\n", BENCH_CORPUS);
+      free (times);
+      journal_free (&journal);
+      tables_free (&boards);
+      return 1;
+    }
+
+    names = (const char **) corpus.gl_pathv;
+    name_count = corpus.gl_pathc;
+  }
+
+  double score = 0;
+  unsigned long long measured = 0;
+
+  for (unsigned long long i = 0; i < name_count; ++i)
+  {
+    struct board_file file = load_board_file (names[i]);
+
+    if (file.fd == -1 || file.data == NULL)
+    {
+      fprintf (stderr, "Could not load benchmark board: %s\n", names[i]);
+      continue;
+    }
+
+    copy_to_board (file, &original);
+    close_board_file (file);
+
+    double median =
+      bench_board (names[i], &original, root_board, &journal, times, runs);
+
+    if (median > 0)
+    {
+      score += median;
+      ++measured;
+    }
+  }
+
+  printf ("bench total boards=%llu score=%.9f\n", measured, score);
+
+  if (path == NULL)
+    globfree (&corpus);
+  free (times);
+  journal_free (&journal);
+  tables_free (&boards);
+
+  return measured == 0;
+}
+
+
+struct args
+argparse (int argc, char **argv)
+{
+  struct args result;
+  result.file_name = NULL;
+  result.valid = true;
+  result.batch = false;
+  result.pack = false;
+  result.stats = false;
+  result.trans = false;
+  result.count = false;
+  result.memo = false;
+  result.generate = 0;
+  result.bench = 0;
+  result.effort = 0;
+  result.checkpoint = NULL;
+  result.order = VALUE_ORDER_ASCENDING;
+  result.verbosity = 0;
+  result.jobs = 1;
+  if (argc < 2)
+  {
+    result.valid = false;
+    return result;
+  }
+
+  for (int i = 1; i < argc; ++i)
+    if (strncmp (argv[i], "-", 1) == 0)
+    {
+      if (strcmp (argv[i], "-v") == 0 && result.verbosity == 0)
         result.verbosity = 1;
-      else if (strcmp (argv[i], "-vv") == 0)
+      else if (strcmp (argv[i], "-vv") == 0 && result.verbosity == 0)
         result.verbosity = 2;
+      else if (strcmp (argv[i], "-b") == 0 && ! result.batch)
+        result.batch = true;
+      else if (strcmp (argv[i], "-s") == 0 && ! result.stats)
+        result.stats = true;
+      else if (strcmp (argv[i], "-p") == 0 && ! result.pack)
+        result.pack = true;
+      else if (strcmp (argv[i], "-t") == 0 && ! result.trans)
+        result.trans = true;
+      else if (strcmp (argv[i], "-c") == 0 && ! result.count)
+        result.count = true;
+      else if (strcmp (argv[i], "-m") == 0 && ! result.memo)
+        result.memo = true;
+      else if (strncmp (argv[i], "-o", 2) == 0 && result.order == 0)
+      {
+        int order = atoi (argv[i] + 2);
+        if (order < 0 || order > VALUE_ORDER_LEAST_CONSTRAINING)
+        {
+          result.valid = false;
+          return result;
+        }
+        result.order = order;
+      }
+      else if (strncmp (argv[i], "-C", 2) == 0 && result.checkpoint == NULL)
+      {
+        if (argv[i][2] == '\0')
+        {
+          result.valid = false;
+          return result;
+        }
+        result.checkpoint = argv[i] + 2;
+      }
+      else if (strncmp (argv[i], "-B", 2) == 0 && result.bench == 0)
+      {
+        if (argv[i][2] == '\0')
+          result.bench = BENCH_DEFAULT_RUNS;
+        else
+        {
+          long long bench = atoll (argv[i] + 2);
+          if (bench < 1)
+          {
+            result.valid = false;
+            return result;
+          }
+          result.bench = bench;
+        }
+      }
+      else if (strncmp (argv[i], "-e", 2) == 0 && result.effort == 0)
+      {
+        long long effort = atoll (argv[i] + 2);
+        if (effort < 1)
+        {
+          result.valid = false;
+          return result;
+        }
+        result.effort = effort;
+      }
+      else if (strncmp (argv[i], "-g", 2) == 0 && result.generate == 0)
+      {
+        long long generate = atoll (argv[i] + 2);
+        if (generate < 1)
+        {
+          result.valid = false;
+          return result;
+        }
+        result.generate = generate;
+      }
+      else if (strncmp (argv[i], "-j", 2) == 0 && result.jobs == 1)
+      {
+        int jobs = atoi (argv[i] + 2);
+        if (jobs < 1)
+        {
+          result.valid = false;
+          return result;
+        }
+        result.jobs = jobs;
+      }
       else
       {
         result.valid = false;
@@ -496,10 +3247,33 @@ main (int argc, char **argv, char **env)
   struct args args = argparse (argc, argv);
   if (! args.valid)
   {
-    fputs ("Badly formatted arguments! Usage:\n\t./sudoku [-v[v]] {file name}\n", stderr);
+    fputs ("Badly formatted arguments! Usage:\n\t./sudoku [-v[v]] [-b] [-B[N]] [-c] [-C<file>] [-eN] [-m] [-p] [-s] [-t] [-gN] [-jN] [-oN] {file name}\n", stderr);
     return 1;
   }
-  
+
+  value_order = args.order;
+
+  if (args.generate > 0)
+    return generate_batch (args.generate, args.stats);
+
+  /* Generation grades with unbounded search, so the budget applies from
+     here on */
+  effort_budget = args.effort;
+
+  if (args.pack)
+    return pack_batch (args.file_name);
+
+  if (args.trans)
+    trans_table = calloc (1ULL << TRANS_BITS, sizeof (*trans_table));
+
+  if (args.bench > 0)
+    return bench_batch (args.file_name, args.bench);
+
+  if (args.batch)
+    return solve_batch (
+        args.file_name, args.stats, args.jobs, args.count, args.memo
+    );
+
   struct board_file file = load_board_file (args.file_name);
   if (file.fd == -1 || file.data == NULL)
     return -1;
@@ -510,9 +3284,10 @@ main (int argc, char **argv, char **env)
   struct board original;
 
   struct boards_table boards;
-  boards.max_depth = 0;
-  boards.board_specs = NULL;
-  tables_ensure_depth (&boards, 0);
+  tables_init (&boards);
+
+  struct board_journal journal;
+  journal_init (&journal);
 
   struct board *root_board = boards.board_specs[0];
 
@@ -545,26 +3320,88 @@ main (int argc, char **argv, char **env)
   clock_t start_clk = clock ();
 
   unsigned long long counter = 0;
-  
-  simplify (&boards, 0, &counter, args.verbosity);
+  unsigned long long solutions = 0;
+
+  pthread_t render_thread;
+  bool rendering = args.verbosity > 0 && ! args.count && args.jobs == 1;
+
+  /* Checkpointing covers the sequential solving search only */
+  if (args.checkpoint != NULL && ! args.count && args.jobs == 1)
+  {
+    checkpoint_path = args.checkpoint;
+
+    struct sigaction action;
+    memset (&action, 0, sizeof action);
+    action.sa_handler = checkpoint_signal;
+    sigaction (SIGINT, &action, NULL);
+    sigaction (SIGTERM, &action, NULL);
+  }
+
+  if (rendering)
+    render_start (&render_thread, root_board);
+
+  if (args.count)
+    solutions = count_solutions (root_board, &journal, 2);
+  else if (args.jobs > 1)
+    simplify_parallel (root_board, args.jobs);
+  else
+    simplify (root_board, &journal, &counter, args.verbosity);
 
   /* Profiler end time */
   clock_t end_clk = clock ();
 
+  if (rendering)
+    render_stop (render_thread);
+
   ansi_clear_screen ();
 
-  if (root_board->complexity == 0)
+  if (solve_interrupted)
+  {
+    fprintf (stderr, "Search state checkpointed to %s\n", checkpoint_path);
+    ansi_cursor_show (true);
+    return 2;
+  }
+
+  /* Too hard for the budget: report the effort profile, not "unsolvable" */
+  if (solve_over_budget)
+  {
+    fprintf (
+        stderr,
+        "Effort budget of %llu nodes exceeded "
+        "(guesses=%llu max_depth=%llu)\n",
+        effort_budget,
+        solve_stats.guesses,
+        solve_stats.max_depth
+    );
+    ansi_cursor_show (true);
+    return 3;
+  }
+
+  /* The search ran to completion, so any checkpoint is stale */
+  if (checkpoint_path != NULL)
+    unlink (checkpoint_path);
+
+  if (args.count)
+    printf ("Solutions: %llu%s\n", solutions, solutions > 1 ? "+" : "");
+  else if (root_board->complexity == 0)
   {
     print_board (&original, NULL, 0, 0);
-    print_board (root_board, &original, 21, 0);
-    ansi_set_cursor (0, 18);
+    print_board (root_board, &original, (2 * BOARD_DIM) + 3, 0);
+    ansi_set_cursor (0, 2 * BOARD_DIM);
   }
   else
   {
     print_board_verbose (root_board, 0, 0);
-    ansi_set_cursor (0, 36);
+    ansi_set_cursor (0, BOARD_DIM * (BOARD_SUB + 1));
   }
-  printf ("Simplification took %Lf seconds\n", ((long double)(end_clk - start_clk))/CLOCKS_PER_SEC);
+  solve_stats.boards = 1;
+  solve_stats.solve_time =
+    ((long double) (end_clk - start_clk)) / CLOCKS_PER_SEC;
+
+  printf ("Simplification took %Lf seconds\n", solve_stats.solve_time);
+
+  if (args.stats)
+    stats_print (stdout);
 
 
   ansi_cursor_show (true);
@@ -0,0 +1,33 @@
+/**
+ * Solver statistics implementation
+ */
+
+#include "stats.h"
+
+
+struct solve_stats solve_stats;
+
+
+void
+stats_print (FILE *stream)
+{
+  fprintf (
+      stream,
+      "boards=%llu nodes=%llu guesses=%llu failed_places=%llu "
+      "singles=%llu hidden_singles=%llu subset_elims=%llu "
+      "region_prunes=%llu tt_hits=%llu memo_hits=%llu "
+      "max_depth=%llu solve_time=%Lf\n",
+      solve_stats.boards,
+      solve_stats.nodes,
+      solve_stats.guesses,
+      solve_stats.failed_places,
+      solve_stats.singles,
+      solve_stats.hidden_singles,
+      solve_stats.subset_elims,
+      solve_stats.region_prunes,
+      solve_stats.tt_hits,
+      solve_stats.memo_hits,
+      solve_stats.max_depth,
+      solve_stats.solve_time
+  );
+}
@@ -0,0 +1,47 @@
+/**
+ * Solver statistics
+ *
+ * Cheap counters bumped from the hot solving paths, emitted on exit as one
+ * machine-readable key=value line so heuristic changes can be compared by
+ * node rate instead of wall time alone
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+
+
+struct solve_stats {
+  unsigned long long nodes;           /* Calls into simplify */
+  unsigned long long guesses;         /* Speculative placements attempted */
+  unsigned long long failed_places;   /* Rejected placements */
+  unsigned long long singles;         /* Naked singles placed */
+  unsigned long long hidden_singles;  /* Hidden singles placed */
+  unsigned long long subset_elims;    /* Naked subset candidates eliminated */
+  unsigned long long region_prunes;   /* Regions caught without candidates */
+  unsigned long long tt_hits;         /* Branches pruned by the table (-t) */
+  unsigned long long memo_hits;       /* Boards answered from the cache (-m) */
+  unsigned long long boards;          /* Boards solved or attempted */
+  unsigned long long depth;           /* Current speculation depth */
+  unsigned long long max_depth;       /* Deepest speculation depth reached */
+  long double solve_time;             /* Seconds spent solving */
+};
+
+
+/**
+ * Global statistics instance
+ *
+ * Counters are plain loads and stores: under parallel solving (-j) workers
+ * may lose the odd increment, which is acceptable for profiling output
+ */
+extern struct solve_stats solve_stats;
+
+
+/**
+ * Emit all statistics as a single key=value line
+ */
+void
+stats_print (FILE *stream);
+
+#endif /* STATS_H */